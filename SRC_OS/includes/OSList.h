@@ -27,11 +27,18 @@
 //							Macros
 //////////////////////////////////////////////////////////////////////////////
 
+///
+/// The scheduling policy is the readyList interface below: insert, 
+/// remove, pick-next and tick, plus the sort key and the hook for a 
+/// changed deadline. The kernel only touches the readyList through it.
+///
+
 ///
 /// @def	OSList_readyInsert(list, listobj);
 ///
-/// Will insert a value into list in ascending order 
-/// according to deadline.
+/// Will insert a value into list in the order of the scheduling policy,
+/// the head of the readyList is the task to run next. SCHED_EDF sorts
+/// by deadline, SCHED_DM by relative deadline and SCHED_FP by priority.
 /// 
 /// @brief	A macro that defines Operating system list ready insert.
 ///
@@ -41,9 +48,111 @@
 /// @param	list   	The list.
 /// @param	listobj	The listobj.
 ///
+
+///
+/// @def	OSList_readyRemove(list, listobj);
+///
+/// @brief	Removes a task from the readyList, returns false if it is not in it.
+///
+/// @param	list   	The list.
+/// @param	listobj	The listobj.
+///
+
+///
+/// @def	OSList_readyPeek(list);
+///
+/// @brief	The task the policy runs next, NULL if the list is empty.
+///
+/// @param	list	The list.
+///
+
+///
+/// @def	OSList_readyKey(listobj);
+///
+/// @brief	The value the readyList is sorted by, lower runs first.
+///
+/// @param	listobj	The listobj.
+///
+
+///
+/// @def	OSList_readyDeadlineChanged(list, listobj);
+///
+/// @brief	Moves a task in the readyList after its deadline has changed,
+/// 		only EDF orders the readyList by deadline.
+///
+/// @param	list   	The list.
+/// @param	listobj	The listobj.
+///
+
+///
+/// @def	OSList_readyTick(list);
+///
+/// Called every tick before tasks are released, lets a policy age or 
+/// rotate the tasks in the readyList. Returns true if it reordered the
+/// list so that the running task is preempted. None of the policies 
+/// reorders on the tick, their order only changes on insert and remove.
+/// 
+/// @brief	The scheduling policy tick hook.
+///
+/// @param	list	The list.
+///
+#if SCHED_POLICY == SCHED_FP
+#define OSList_readyInsert(list, listobj) \
+				OSList_priorityInsert(list, listobj) \
+
+#define OSList_readyRemove(list, listobj) \
+				OSList_priorityRemove(list, listobj) \
+
+#define OSList_readyPeek(list) \
+				OSList_peek(list) \
+
+#define OSList_readyKey(listobj) \
+				((listobj)->nPriority) \
+
+#define OSList_readyDeadlineChanged(list, listobj) \
+
+#define OSList_readyTick(list) \
+				(false) \
+
+#elif SCHED_POLICY == SCHED_DM
+#define OSList_readyInsert(list, listobj) \
+				OSList_levelInsert(list, listobj) \
+
+#define OSList_readyRemove(list, listobj) \
+				OSList_remove(list, listobj) \
+
+#define OSList_readyPeek(list) \
+				OSList_peek(list) \
+
+#define OSList_readyKey(listobj) \
+				((listobj)->nRelDeadline) \
+
+#define OSList_readyDeadlineChanged(list, listobj) \
+
+#define OSList_readyTick(list) \
+				(false) \
+
+#else
 #define OSList_readyInsert(list, listobj) \
 				OSList_deadlineInsert(list, listobj) \
 
+#define OSList_readyRemove(list, listobj) \
+				OSList_remove(list, listobj) \
+
+#define OSList_readyPeek(list) \
+				OSList_peek(list) \
+
+#define OSList_readyKey(listobj) \
+				((listobj)->pTask->DeadLine) \
+
+#define OSList_readyDeadlineChanged(list, listobj) \
+				OSList_deadlineReposition(list, listobj) \
+
+#define OSList_readyTick(list) \
+				(false) \
+
+#endif
+
 ///
 /// @def	OSList_waitingInsert(list, listobj);
 ///
@@ -88,10 +197,12 @@
 /// @author	Albin Hjalmas
 /// @date	1/24/2017
 ///
-typedef struct {
+typedef struct oslist {
 	uint32_t size;			///<Current size of the list i.e. the number of elements.
 	listobj* pHead;			///<A pointer to the frontmost element in this list.
 	listobj* pTail;			///<A pointer to the last element in this list.
+	uint32_t priorityBitmap;	///<The priorities present, used by OSList_priorityInsert.
+	listobj* priorityTail[SCHED_PRIORITIES];	///<The last task of each priority present.
 } OSList_t;
 
 //////////////////////////////////////////////////////////////////////////////
@@ -132,6 +243,36 @@ OSList_t*	OSList_create(void);
 ///
 bool		OSList_timerInsert(OSList_t* list, listobj* element, uint delay);
 
+///
+/// @fn	bool OSList_timerInsertAt(OSList_t* list, listobj* element, uint nTCnt);
+///
+/// @brief	Inserts a task into the timer list to be released at the 
+/// 		absolute tick nTCnt.
+///
+/// @param [in,out]	list   	If non-null, the list which to insert to.
+/// @param [in,out]	element	If non-null, the element to insert into the list.
+/// @param 		   	nTCnt  	The tick at which to release the given task.
+///
+/// @return	True if it succeeds, false if it fails.
+///
+bool		OSList_timerInsertAt(OSList_t* list, listobj* element, uint nTCnt);
+
+///
+/// @fn	bool OSList_timerInsertSlack(OSList_t* list, listobj* element, uint nTCnt, uint nSlack);
+///
+/// @brief	Inserts a task into the timer list to be released at the 
+/// 		first existing release within nTCnt to nTCnt + nSlack, or at
+/// 		nTCnt if there is none.
+///
+/// @param [in,out]	list   	If non-null, the list which to insert to.
+/// @param [in,out]	element	If non-null, the element to insert into the list.
+/// @param 		   	nTCnt  	The earliest tick at which to release the given task.
+/// @param 		   	nSlack 	The ticks the release may be postponed.
+///
+/// @return	True if it succeeds, false if it fails.
+///
+bool		OSList_timerInsertSlack(OSList_t* list, listobj* element, uint nTCnt, uint nSlack);
+
 ///
 /// @fn	bool OSList_deadlineInsert(OSList_t* list, listobj* element);
 ///
@@ -149,6 +290,93 @@ bool		OSList_timerInsert(OSList_t* list, listobj* element, uint delay);
 ///
 bool		OSList_deadlineInsert(OSList_t* list, listobj* element);
 
+///
+/// @fn	bool OSList_deadlineReposition(OSList_t* list, listobj* element);
+///
+/// Moves a listobject whose deadline has changed to its new position in a
+/// list sorted by deadline. The neighbours are searched from the current
+/// position, which is short when the deadline changes by little.
+/// 
+/// @brief	Repositions a listobject in place.
+///
+/// @param [in,out]	list   	If non-null, the list that contains the element.
+/// @param [in,out]	element	If non-null, the element.
+///
+/// @return	True if it succeeds, false if it fails.
+///
+bool		OSList_deadlineReposition(OSList_t* list, listobj* element);
+
+///
+/// @fn	bool OSList_levelInsert(OSList_t* list, listobj* element);
+///
+/// Inserts a listobject in ascending order according to the relative 
+/// deadline, tasks with the same relative deadline are kept in FIFO order.
+/// 
+/// @brief	Deadline monotonic ready insert.
+///
+/// @param [in,out]	list   	If non-null, the list.
+/// @param [in,out]	element	If non-null, the element.
+///
+/// @return	True if it succeeds, false if it fails.
+///
+bool		OSList_levelInsert(OSList_t* list, listobj* element);
+
+///
+/// @fn	bool OSList_priorityInsert(OSList_t* list, listobj* element);
+///
+/// Inserts a listobject after the last task with the same or a higher 
+/// priority in constant time. A bitmap of the priorities in the list and
+/// the last task of each priority are kept in the list, hence tasks must
+/// be removed by OSList_priorityRemove.
+/// 
+/// @brief	Fixed priority ready insert.
+///
+/// @param [in,out]	list   	If non-null, the list.
+/// @param [in,out]	element	If non-null, the element.
+///
+/// @return	True if it succeeds, false if it fails.
+///
+bool		OSList_priorityInsert(OSList_t* list, listobj* element);
+
+///
+/// @fn	bool OSList_priorityRemove(OSList_t* list, listobj* element);
+///
+/// @brief	Removes a listobject inserted by OSList_priorityInsert.
+///
+/// @param [in,out]	list   	If non-null, the list.
+/// @param [in,out]	element	If non-null, the element.
+///
+/// @return	True if it succeeds, false if the element is not in the list.
+///
+bool		OSList_priorityRemove(OSList_t* list, listobj* element);
+
+///
+/// @fn	bool OSList_contains(OSList_t* list, listobj* element);
+///
+/// @brief	Checks in constant time if an element is in a list.
+///
+/// @param [in]	list   	The list.
+/// @param [in]	element	If non-null, the element.
+///
+/// @return	True if the element is in the list.
+///
+bool		OSList_contains(OSList_t* list, listobj* element);
+
+///
+/// @fn	bool OSList_frontInsert(OSList_t* list, listobj* element);
+///
+/// Inserts a listobject at the front of the list in constant time, 
+/// used for lists that are not sorted.
+/// 
+/// @brief	Operating system list front insert.
+///
+/// @param [in,out]	list   	If non-null, the list.
+/// @param [in,out]	element	If non-null, the element.
+///
+/// @return	True if it succeeds, false if it fails.
+///
+bool		OSList_frontInsert(OSList_t* list, listobj* element);
+
 ///
 /// @fn	listobj* OSList_getFirst(OSList_t* list);
 ///
@@ -169,6 +397,9 @@ listobj*	OSList_getFirst(OSList_t* list);
 ///
 /// @fn	bool OSList_remove(OSList_t* list, listobj* element);
 ///
+/// Removes the element in constant time, every element knows the list
+/// it is in.
+/// 
 /// @brief	Operating system list remove.
 ///
 /// @author	Albin Hjalmas.
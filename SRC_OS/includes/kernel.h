@@ -2,7 +2,9 @@
 /// This file defines the application programming interface to the kernel.
 /// Please define what architecture you intend to run the kernel on.
 /// for texas dsp simply define "texas dsp", for ARM cortex-m processors 
-/// (no FPU support) please define "_CORTEX_M_", for x86 architecture
+/// (no FPU support) please define "_CORTEX_M_", for ARM cortex-m processors
+/// with a single precision FPU (Cortex-M4F) please define both "_CORTEX_M_" 
+/// and "_CORTEX_M_FPU_", for x86 architecture
 /// Please define "X86". If you intend to run this kernel on x86 architecture
 /// please instatiate a new thread that periodically calls the timerISR(); 
 /// routine. 
@@ -29,6 +31,7 @@ extern "C" {
 //								Includes
 //////////////////////////////////////////////////////////////////////////////
 #include <stdlib.h>
+#include <stdbool.h>
 
 
 //////////////////////////////////////////////////////////////////////////////
@@ -43,6 +46,14 @@ extern "C" {
 #elif _CORTEX_M_						///< If defined: this kernel will execute on Cortex-m architecture
 #define CONTEXT_SIZE    13				///< Number of general purpose registers
 #define STACK_SIZE      200				///< Size of task stack
+#ifdef _CORTEX_M_FPU_
+#define FPU_CONTEXT_SIZE 16				///< Number of callee-saved FPU registers (s16-s31)
+#endif
+#ifndef KERNEL_INTERRUPT_PRIORITY
+#define KERNEL_INTERRUPT_PRIORITY 5		///< Priority ceiling of kernel critical sections. Interrupts with a
+										///< numerically lower (more urgent) NVIC priority are never masked
+										///< by the kernel and must not call any kernel function.
+#endif
 
 #elif _X86_								///< If defined: this kernel will execute on x86 architecture
 #define CONTEXT_SIZE	8				///< Number of general purpose registers
@@ -50,6 +61,25 @@ extern "C" {
 
 #endif
 
+//////////////////////////////////////////////////////////////////////////////
+//							Scheduling policy
+//	Define SCHED_POLICY as one of the policies below when building the 
+//	kernel, earliest deadline first is used by default.
+//////////////////////////////////////////////////////////////////////////////
+#define SCHED_EDF               0		///<Earliest deadline first.
+#define SCHED_DM                1		///<Deadline monotonic, shortest relative deadline first.
+#define SCHED_FP                2		///<Fixed priority, set by set_priority().
+
+#ifndef SCHED_POLICY
+#define SCHED_POLICY            SCHED_EDF
+#endif
+
+#define SCHED_PRIORITIES        32		///<Number of priorities, 0 is the highest and the last is the idle task.
+
+#ifndef TIME_SLICE_TICKS
+#define TIME_SLICE_TICKS        0		///<Initial ticks before a task yields to a ready task with the same deadline, 0 disables time slicing.
+#endif
+
 //////////////////////////////////////////////////////////////////////////////
 //							Defines
 //////////////////////////////////////////////////////////////////////////////
@@ -72,11 +102,38 @@ extern "C" {
 //misc
 #define DEADLINE_REACHED        0		///<This tasks deadline has been reached.
 #define NOT_EMPTY               0		///<There are messages in the mailbox.
+#define TIMEOUT_REACHED         2		///<The timeout of a blocking call expired before its deadline.
+#define NO_REPLY                3		///<The server terminated without replying to a call().
 
 //Who put the msg item into the mailbox ...
 #define SENDER          +1				///<It was a sender who wants to send a message.
 #define RECEIVER        -1				///<It was a receiver who wants to receive a message.
 
+//Notification actions
+#define NOTIFY_SET_BITS         1		///<Set bits in the notification word.
+#define NOTIFY_OVERWRITE        2		///<Overwrite the notification word.
+#define NOTIFY_INCREMENT        3		///<Increment the notification word.
+
+//Overrun policies
+#define OVERRUN_NONE            0		///<The task keeps running after its deadline.
+#define OVERRUN_SKIP            1		///<The job is dropped, the task restarts at its next release.
+#define OVERRUN_ABORT           2		///<The body is restarted with a new deadline.
+#define OVERRUN_DEMOTE          3		///<The task continues in the background, SCHED_EDF only.
+#define OVERRUN_HANDLER         4		///<A handler decides the new deadline.
+
+//Idle hooks
+#define MAX_IDLE_HOOKS          4		///<Maximum number of registered idle hooks.
+
+//receive_any
+#ifndef MAX_RECEIVE_ANY
+#define MAX_RECEIVE_ANY         4		///<Maximum number of mailboxes of one receive_any() call, sizes its stack frame.
+#endif
+
+//Admission control
+#ifndef ADMISSION_MAX_INTERVAL
+#define ADMISSION_MAX_INTERVAL  1000	///<Longest interval in ticks the demand test checks with interrupts disabled.
+#endif
+
 //////////////////////////////////////////////////////////////////////////////
 ///							Typedefs
 //////////////////////////////////////////////////////////////////////////////
@@ -124,6 +181,7 @@ typedef struct
 	uint	Context[CONTEXT_SIZE];	///<This tasks context i.e. the register contents. 
 	uint	StackSeg[STACK_SIZE];	///<This tasks stack.
 	uint	DeadLine;				///<This tasks deadline.
+	uint	Notification;			///<This tasks notification word.
 } TCB;
 
 #elif _CORTEX_M_
@@ -133,6 +191,9 @@ typedef struct
 ///
 /// Please make shure that this TCB corresponds to the context on
 /// The cpu on which you intend to run the OS on.
+/// When _CORTEX_M_FPU_ is defined the FPU registers are only saved for
+/// tasks that have touched the FPU (CONTROL.FPCA is set), all other
+/// tasks are switched at the same cost as on a core without FPU.
 /// 
 /// @brief	A Task control block in accordance to
 /// 		the context provided on the ARM Cortex-m processors.
@@ -156,8 +217,14 @@ typedef struct
     uint    *SP;						///<Apointer to this tasks TOS (Top of stack)
     void    (*PC)();					///<A pointer to the next line of code to be executed.
     uint    SPSR;						///<The current status flags for this task.
+#ifdef _CORTEX_M_FPU_
+	uint	FPUsed;						///<Non-zero if FPU state was saved i.e. the task has touched the FPU.
+	uint	FPContext[FPU_CONTEXT_SIZE];///<This tasks callee-saved FPU registers s16-s31.
+	uint	FPSCR;						///<This tasks FPU status and control register.
+#endif
     uint    StackSeg[STACK_SIZE];		///<This tasks stack.
     uint    DeadLine;					///<This tasks deadline.
+    uint    Notification;				///<This tasks notification word.
 } TCB;
 
 #elif _X86_
@@ -174,6 +241,7 @@ typedef struct {
 	void    (*PC)(void);					///<A pointer to the next line of code to be executed.
 	uint    StackSeg[STACK_SIZE];			///<This tasks stack.
     uint    DeadLine;						///<This tasks deadline.
+    uint    Notification;					///<This tasks notification word.
 } TCB;
 
 #else
@@ -185,11 +253,14 @@ typedef struct {
 //////////////////////////////////////////////////////////////////////////////
 
 struct  l_obj;					// Forward declaration
+struct  mbox;					// Forward declaration
+struct  oslist;					// Forward declaration
 
 ///
 /// @struct	msgobj
 /// A message object used by both receiver and sender to receive/send messages thru
-/// a mailbox.
+/// a mailbox. Queued messages are also nodes of a balanced search tree on the
+/// deadlines of their tasks, whose root is the right child of the head sentinel.
 /// 
 /// @brief	A msgobj.
 ///
@@ -199,13 +270,23 @@ typedef struct msgobj {
         struct l_obj    *pBlock;			///<A pointer to the creator of the message.
         struct msgobj   *pPrevious;			///<A pointer to the previous message in the mailbox.
         struct msgobj   *pNext;				///<A pointer to the next message in the mailbox.
+        struct msgobj   *pSibling;			///<Ring of messages of one receive_any() call, or NULL.
+        struct mbox     *pMailbox;			///<The mailbox of a receive_any() or call() message.
+        char            *pReply;			///<The reply buffer of a call() message, else NULL.
+        struct msgobj   *pParent;			///<The parent in the deadline tree, the head sentinel for the root.
+        struct msgobj   *pLeft;				///<The subtree of earlier deadlines.
+        struct msgobj   *pRight;			///<The subtree of later or equal deadlines.
+        int             nHeight;			///<The height of the subtree of this message.
 } msg;
 
 ///
 /// @struct	mailbox
+/// Messages of blocked senders or receivers are kept in the order of the
+/// deadlines of their tasks so that the most urgent task is served first.
+/// 
 /// @brief	A mailbox.
 ///
-typedef struct {
+typedef struct mbox {
         msg             *pHead;				///<The frontmost message in this mailbox.
         msg             *pTail;				///<The last message in this mailbox.
         int             nDataSize;			///<The size in bytes of messages in this mailbox.
@@ -214,6 +295,97 @@ typedef struct {
         int             nBlockedMsg;		///<The number of messages waiting to be received/sent.
 } mailbox;
 
+///
+/// @struct	semaphore
+/// A counting semaphore, tasks waiting for a token are queued in 
+/// deadline order using msg items allocated on their own stacks.
+/// 
+/// @brief	A counting semaphore.
+///
+typedef struct {
+        msg             *pHead;				///<Sentinel in front of the first waiting task.
+        msg             *pTail;				///<Sentinel behind the last waiting task.
+        uint            nCount;				///<The number of available tokens.
+} semaphore;
+
+///
+/// @struct	eventgroup
+/// A set of event bits, tasks waiting for a combination of bits are 
+/// queued in deadline order using msg items allocated on their own stacks.
+/// 
+/// @brief	An event group.
+///
+typedef struct {
+        msg             *pHead;				///<Sentinel in front of the first waiting task.
+        msg             *pTail;				///<Sentinel behind the last waiting task.
+        uint            nBits;				///<The event bits that are set.
+} eventgroup;
+
+struct  pubbuf;					// Forward declaration, private to the kernel
+struct  topicobj;				// Forward declaration
+
+///
+/// @struct	subscriber
+/// A subscription to a topic, published buffers are queued in a ring
+/// and counted by a semaphore that the subscribing task waits on.
+/// 
+/// @brief	A subscriber.
+///
+typedef struct subscr {
+        struct topicobj *pTopic;			///<The topic subscribed to.
+        char            **ppRing;			///<Published buffers not yet received.
+        uint            nDepth;				///<The capacity of the ring.
+        uint            nHead;				///<Index of the oldest buffer in the ring.
+        uint            nCount;				///<The number of buffers in the ring.
+        uint            nDropped;			///<Publications lost because the ring was full.
+        semaphore       *pSem;				///<Counts the buffers in the ring.
+        struct subscr   *pNext;				///<The next subscriber of the topic.
+} subscriber;
+
+///
+/// @struct	topic
+/// A topic fans publications out to all subscribers without copying,
+/// every subscriber receives a pointer to the same reference counted
+/// buffer which returns to the pool of the topic when it is released
+/// by the last subscriber.
+/// 
+/// @brief	A publish/subscribe topic.
+///
+typedef struct topicobj {
+        uint            nDataSize;			///<The size in bytes of a buffer.
+        uint            nBuffers;			///<The number of buffers in the pool.
+        char            *pPool;				///<Memory of all buffers.
+        struct pubbuf   *pFree;				///<Buffers that can be claimed.
+        uint            nClaimed;			///<The number of buffers out of the pool.
+        subscriber      *pSubscribers;		///<The subscribers of this topic.
+} topic;
+
+///
+/// @struct	channel
+/// A latest-value channel that keeps two copies of the value. The parity
+/// of the sequence selects the copy readers use, the writer advances the
+/// sequence before it overwrites a copy so that readers never see a copy
+/// that is being written. Readers retry if the sequence changed during 
+/// their copy, they never wait for a preempted writer.
+/// 
+/// @brief	A latest-value channel.
+///
+typedef struct {
+        volatile uint   nSeq;				///<The sequence, its parity selects the copy to read.
+        volatile bool   bWritten;			///<True once a value has been written.
+        uint            nDataSize;			///<The size in bytes of a value.
+        char            *pData;				///<The two copies of the latest value.
+} channel;
+
+///
+/// @struct	ttslot
+/// @brief	A slot of a time-triggered dispatch table.
+///
+typedef struct {
+        uint            nOffset;			///<The tick within the hyperperiod at which the slot starts.
+        void            (*pBody)(void);		///<The function run to completion in the slot.
+} ttslot;
+
 ///
 /// @struct	l_obj
 /// @brief	Defines an item stored in the OSList_t lists.
@@ -222,10 +394,48 @@ typedef struct l_obj {
          TCB            *pTask;				///<A pointer to this listobjects task.
          uint           nTCnt;				///<Sorting argument used in 
          msg            *pMessage;			///<A pointer back to the message belonging to this task.
+         uint           nRelDeadline;		///<Relative deadline, the preemption level of this task (shorter is higher).
+         uint           nLocks;				///<The number of mutexes held by this task.
+         struct mutexobj *pLocked;			///<The mutex this task locked last, NULL if none.
+         uint           nNotifyMask;		///<The notification bits this task is blocked on, 0 if not blocked.
+         msg            *pCall;				///<The call() this task is handling as a server, or NULL.
+         uint           nSavedDeadline;		///<The deadline of this task before it inherited the deadline of a caller.
+         uint           nPeriod;			///<The period of a periodic task, 0 for other tasks.
+         uint           nRelease;			///<The release time of the current job of a periodic task.
+         uint           nCbsBudget;			///<The budget per period of a CBS task, 0 for other tasks.
+         uint           nCbsRemaining;		///<The remaining budget of a CBS task.
+         uint           nCbsPeriod;			///<The period of the server of a CBS task.
+         void           (*pBody)();			///<The body of this task, used to restart it.
+         uint           nOverrunPolicy;		///<What the kernel does when this task overruns its deadline.
+         uint           (*pOverrunHandler)(struct l_obj*);	///<Returns the new deadline of a task that overran.
+         uint           nWcet;				///<The declared worst case execution time, 0 if not admitted.
+         struct l_obj   *pAdmitted;			///<Next task in the set of admitted tasks.
+         uint           nThreshold;			///<How much earlier a deadline must be to preempt this task.
+         uint           nPreemptClass;		///<Tasks in a higher class preempt this task regardless of the threshold.
+         uint           nPriority;			///<The priority of this task under SCHED_FP, 0 is the highest.
+         struct oslist  *pList;				///<The list this task is in, or NULL.
          struct l_obj   *pPrevious;			///<Previous task in list.
          struct l_obj   *pNext;				///<Next task in list.
 } listobj;
 
+///
+/// @struct	mutex
+/// A mutex following the Stack Resource Policy (SRP). The ceiling of a mutex
+/// is the shortest relative deadline of all tasks that lock it. While it is
+/// locked only tasks with a shorter relative deadline than the ceiling may
+/// preempt the owner, hence a task never blocks on a mutex and is blocked
+/// at most for the duration of one critical section. Tasks with the same 
+/// preemption level never preempt each other.
+/// 
+/// @brief	A mutex.
+///
+typedef struct mutexobj {
+        listobj         *pOwner;			///<The task holding the mutex, NULL if free.
+        uint            nCeiling;			///<The ceiling of this mutex.
+        uint            nPrevCeiling;		///<The system ceiling before this mutex was locked.
+        struct mutexobj *pPrevLocked;		///<The mutex the owner locked before this one.
+} mutex;
+
 /*
 ///
 /// @struct	list
@@ -249,9 +459,88 @@ typedef struct {
 exception	init_kernel(void);
 exception	create_task( void (* body)(), uint d );
 void            terminate(void);
+
+// Creates a task that is released every nPeriod ticks starting nOffset 
+// ticks from now, each job has the deadline release + nRelDeadline
+exception	create_periodic_task( void (* body)(), uint nPeriod, uint nRelDeadline, uint nOffset );
+// Creates a periodic task with a worst case execution time of nWcet ticks
+// if the admitted tasks stay schedulable by EDF, else FAIL is returned.
+// Fails unless SCHED_POLICY is SCHED_EDF.
+// Task sets whose demand would have to be checked over more than 
+// ADMISSION_MAX_INTERVAL ticks are rejected
+exception	create_admitted_task( void (* body)(), uint nWcet, uint nPeriod, uint nRelDeadline, uint nOffset );
+// Creates a task served by a Constant Bandwidth Server that may use
+// nBudget ticks every nPeriod ticks, overruns postpone its deadline.
+// The tick preempts CBS tasks, tasks with an overrun policy and time 
+// sliced tasks at any instruction, code they share with other tasks 
+// must be reentrant. Kernel calls are safe, the kernel does not get
+// preempted while it allocates memory. Fails unless SCHED_POLICY is
+// SCHED_EDF.
+exception	create_cbs_task( void (* body)(), uint nBudget, uint nPeriod );
+// Ends the current job of a periodic task and waits for the next release
+exception	wait_next_period( void );
+// Selects what the kernel does when the calling task is still ready after
+// its deadline, the handler is only used with OVERRUN_HANDLER
+exception	set_overrun_policy( uint nPolicy, uint (* handler)(listobj* pTask) );
+
+// Replaces EDF scheduling by a table of slots repeated every nHyperperiod
+// ticks, must be called before run() and instead of creating tasks
+exception	set_time_triggered( ttslot* pTable, uint nSlots, uint nHyperperiod );
 void            run(void);
 
 
+//////////////////////////////////////////////////////////////////////////////
+///						Idle hook function prototypes.
+//////////////////////////////////////////////////////////////////////////////
+
+///
+/// @fn	exception add_idle_hook( bool (*hook)(void), uint nQuantum );
+///
+/// Registers a hook that is executed by the idle task whenever no other
+/// task is ready. A hook should perform its work in small steps and 
+/// return as soon as idle_hook_expired() returns true. It returns true
+/// if it has more work to do. A hook that returns false is not called 
+/// again until it is armed by arm_idle_hook(), when no hook is armed the
+/// idle task goes to sleep until a task becomes ready.
+/// 
+/// @brief	Registers an idle hook.
+/// @param	hook		The hook.
+/// @param	nQuantum	The maximum number of ticks the hook may run per call.
+///
+/// @return	FAIL if the arguments are bad or MAX_IDLE_HOOKS is reached, else SUCCESS.
+///
+exception	add_idle_hook( bool (*hook)(void), uint nQuantum );
+
+///
+/// @fn	exception remove_idle_hook( bool (*hook)(void) );
+///
+/// @brief	Unregisters an idle hook.
+/// @param	hook	The hook.
+///
+/// @return	FAIL if the hook is not registered, else SUCCESS.
+///
+exception	remove_idle_hook( bool (*hook)(void) );
+
+///
+/// @fn	exception arm_idle_hook( bool (*hook)(void) );
+///
+/// @brief	Arms a hook that has returned false because it has new work,
+/// 		may be called by tasks and interrupt service routines.
+/// @param	hook	The hook.
+///
+/// @return	FAIL if the hook is not registered, else SUCCESS.
+///
+exception	arm_idle_hook( bool (*hook)(void) );
+
+///
+/// @fn	bool idle_hook_expired( void );
+///
+/// @brief	Returns true when the executing idle hook must return, either
+/// 		because a task has become ready or its quantum has elapsed.
+///
+bool		idle_hook_expired( void );
+
+
 ////////////////////////////////////////////////////////////////////////////
 /// 					Communication function prototypes.
 ////////////////////////////////////////////////////////////////////////////
@@ -265,10 +554,429 @@ int         no_messages( mailbox* mBox );
 exception   send_wait( mailbox* mBox, void* pData );
 exception   receive_wait( mailbox* mBox, void* pData );
 
+// Variants that give up after nTimeout ticks, or at the deadline if it is
+// earlier, without changing the deadline of the calling task
+exception   send_wait_timeout( mailbox* mBox, void* pData, uint nTimeout );
+exception   receive_wait_timeout( mailbox* mBox, void* pData, uint nTimeout );
+
+// Receives from the first of nMailboxes (at most MAX_RECEIVE_ANY) mailboxes 
+// that holds a message, pWhich (if non-null) receives the index of that mailbox
+exception   receive_any( mailbox** set, uint nMailboxes, void* pData, uint* pWhich );
+
+// Sends a request and blocks until the receiving task replies, the 
+// receiver inherits the deadline of the caller until it replies. Returns
+// NO_REPLY if the receiver terminated without replying
+exception   call( mailbox* mBox, void* pRequest, void* pReply );
+// Replies to the call() the calling task has received, receiving fails
+// until it has replied
+exception   reply( void* pReply );
+
 exception	send_no_wait( mailbox* mBox, void* pData );
 int         receive_no_wait( mailbox* mBox, void* pData );
 
 
+//////////////////////////////////////////////////////////////////////////////
+///						Task notification function prototypes.
+//////////////////////////////////////////////////////////////////////////////
+
+///
+/// @fn	listobj* current_task( void );
+///
+/// @brief	Returns the calling task, used as handle for notify().
+///
+/// @return	The calling task.
+///
+listobj*	current_task( void );
+
+///
+/// @fn	exception notify( listobj* pTask, uint nValue, action eAction );
+///
+/// Updates the notification word of a task. If the task is blocked in
+/// notify_wait() and one of the bits it waits for is set it is made ready
+/// and preempts the caller if its deadline is earlier.
+/// 
+/// @brief	Notifies a task.
+/// @param	pTask	The task to notify.
+/// @param	nValue	The value, ignored for NOTIFY_INCREMENT.
+/// @param	eAction	NOTIFY_SET_BITS, NOTIFY_OVERWRITE or NOTIFY_INCREMENT.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception	notify( listobj* pTask, uint nValue, action eAction );
+
+///
+/// @fn	exception notify_isr( listobj* pTask, uint nValue, action eAction );
+///
+/// @brief	Notifies a task from an interrupt service routine.
+/// @see	notify()
+///
+/// @return	FAIL or SUCCESS.
+///
+exception	notify_isr( listobj* pTask, uint nValue, action eAction );
+
+///
+/// @fn	exception notify_wait( uint nMask, bool bClearOnExit, uint* pValue );
+///
+/// @brief	Blocks until any of the bits in nMask is set in the notification 
+/// 		word of the calling task or its deadline is reached.
+/// @param	nMask			The bits to wait for.
+/// @param	bClearOnExit	Clear the bits in nMask when returning SUCCESS.
+/// @param	pValue			If non-null, receives the notification word.
+///
+/// @return	FAIL, DEADLINE_REACHED or SUCCESS.
+///
+exception	notify_wait( uint nMask, bool bClearOnExit, uint* pValue );
+
+
+//////////////////////////////////////////////////////////////////////////////
+///							Semaphore function prototypes.
+//////////////////////////////////////////////////////////////////////////////
+
+///
+/// @fn	semaphore* create_semaphore( uint nCount );
+///
+/// @brief	Creates a counting semaphore.
+/// @param	nCount	The initial number of tokens.
+///
+/// @return	Null if it fails, else the new semaphore.
+///
+semaphore*	create_semaphore( uint nCount );
+
+///
+/// @fn	exception remove_semaphore( semaphore* pSem );
+///
+/// @brief	Removes a semaphore.
+/// @param	pSem	The semaphore.
+///
+/// @return	NOT_EMPTY if tasks are waiting on the semaphore, else OK.
+///
+exception	remove_semaphore( semaphore* pSem );
+
+///
+/// @fn	exception give_semaphore( semaphore* pSem );
+///
+/// Gives a token in constant time, the waiting task with the earliest
+/// deadline is woken and preempts the caller if its deadline is earlier.
+/// 
+/// @brief	Gives a semaphore.
+/// @param	pSem	The semaphore.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception	give_semaphore( semaphore* pSem );
+
+///
+/// @fn	exception give_semaphore_isr( semaphore* pSem );
+///
+/// @brief	Gives a semaphore from an interrupt service routine.
+/// @param	pSem	The semaphore.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception	give_semaphore_isr( semaphore* pSem );
+
+///
+/// @fn	exception take_wait( semaphore* pSem );
+///
+/// @brief	Takes a token, blocks until a token is given or the deadline
+/// 		of the calling task is reached.
+/// @param	pSem	The semaphore.
+///
+/// @return	FAIL, DEADLINE_REACHED or SUCCESS.
+///
+exception	take_wait( semaphore* pSem );
+
+///
+/// @fn	exception take_no_wait( semaphore* pSem );
+///
+/// @brief	Takes a token if one is available, never blocks.
+/// @param	pSem	The semaphore.
+///
+/// @return	FAIL if no token was available, else SUCCESS.
+///
+exception	take_no_wait( semaphore* pSem );
+
+
+//////////////////////////////////////////////////////////////////////////////
+///							Event group function prototypes.
+//////////////////////////////////////////////////////////////////////////////
+
+///
+/// @fn	eventgroup* create_event_group( void );
+///
+/// @brief	Creates an event group with all bits cleared.
+///
+/// @return	Null if it fails, else the new event group.
+///
+eventgroup*	create_event_group( void );
+
+///
+/// @fn	exception remove_event_group( eventgroup* pGroup );
+///
+/// @brief	Removes an event group.
+/// @param	pGroup	The event group.
+///
+/// @return	FAIL, NOT_EMPTY if tasks are waiting on the group or OK.
+///
+exception	remove_event_group( eventgroup* pGroup );
+
+///
+/// @fn	exception set_event_bits( eventgroup* pGroup, uint nBits );
+///
+/// Sets bits in the event group. Every waiting task whose condition
+/// becomes true is made ready in a single pass, after which at most one
+/// context switch is made.
+/// 
+/// @brief	Sets event bits.
+/// @param	pGroup	The event group.
+/// @param	nBits 	The bits to set.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception	set_event_bits( eventgroup* pGroup, uint nBits );
+
+///
+/// @fn	exception set_event_bits_isr( eventgroup* pGroup, uint nBits );
+///
+/// @brief	Sets event bits from an interrupt service routine.
+/// @see	set_event_bits()
+///
+/// @return	FAIL or SUCCESS.
+///
+exception	set_event_bits_isr( eventgroup* pGroup, uint nBits );
+
+///
+/// @fn	exception clear_event_bits( eventgroup* pGroup, uint nBits );
+///
+/// @brief	Clears event bits.
+/// @param	pGroup	The event group.
+/// @param	nBits 	The bits to clear.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception	clear_event_bits( eventgroup* pGroup, uint nBits );
+
+///
+/// @fn	exception wait_event_bits( eventgroup* pGroup, uint nMask, bool bWaitAll, bool bClearOnExit, uint* pBits );
+///
+/// @brief	Blocks until any (or all) of the bits in nMask are set or the
+/// 		deadline of the calling task is reached.
+/// @param	pGroup			The event group.
+/// @param	nMask			The bits to wait for.
+/// @param	bWaitAll		Wait for all bits in nMask instead of any.
+/// @param	bClearOnExit	Clear the bits in nMask when returning SUCCESS.
+/// @param	pBits			If non-null, receives the bits that satisfied the wait.
+///
+/// @return	FAIL, DEADLINE_REACHED or SUCCESS.
+///
+exception	wait_event_bits( eventgroup* pGroup, uint nMask, bool bWaitAll, bool bClearOnExit, uint* pBits );
+
+//////////////////////////////////////////////////////////////////////////////
+///							Topic function prototypes.
+//////////////////////////////////////////////////////////////////////////////
+
+///
+/// @fn	topic* create_topic( uint nBuffers, uint nDataSize );
+///
+/// @brief	Creates a topic with a pool of buffers.
+/// @param	nBuffers 	The number of buffers in the pool.
+/// @param	nDataSize	The size in bytes of a buffer.
+///
+/// @return	Null if it fails, else the new topic.
+///
+topic*		create_topic( uint nBuffers, uint nDataSize );
+
+///
+/// @fn	exception remove_topic( topic* pTopic );
+///
+/// @brief	Removes a topic.
+/// @param	pTopic	The topic.
+///
+/// @return	FAIL, NOT_EMPTY if the topic has subscribers or a claimed 
+/// 		buffer, or OK.
+///
+exception	remove_topic( topic* pTopic );
+
+///
+/// @fn	subscriber* subscribe( topic* pTopic, uint nDepth );
+///
+/// @brief	Subscribes to a topic.
+/// @param	pTopic	The topic.
+/// @param	nDepth	The number of publications that can be queued.
+///
+/// @return	Null if it fails, else the new subscriber.
+///
+subscriber*	subscribe( topic* pTopic, uint nDepth );
+
+///
+/// @fn	exception unsubscribe( subscriber* pSub );
+///
+/// @brief	Ends a subscription, queued publications are released.
+/// @param	pSub	The subscriber.
+///
+/// @return	FAIL, NOT_EMPTY if a task is waiting on the subscriber or OK.
+///
+exception	unsubscribe( subscriber* pSub );
+
+///
+/// @fn	void* claim_buffer( topic* pTopic );
+///
+/// @brief	Claims a buffer of the topic to be filled and published.
+/// @param	pTopic	The topic.
+///
+/// @return	Null if the pool is empty, else the buffer.
+///
+void*		claim_buffer( topic* pTopic );
+
+///
+/// @fn	exception publish( topic* pTopic, void* pBuffer );
+///
+/// Hands a claimed buffer to every subscriber, the cost is proportional
+/// to the number of subscribers and independent of the buffer size. 
+/// Subscribers with a full ring miss the publication. At most one 
+/// context switch is made.
+/// 
+/// @brief	Publishes a buffer.
+/// @param	pTopic 	The topic.
+/// @param	pBuffer	A buffer returned by claim_buffer().
+///
+/// @return	FAIL if the buffer is not held or not from the pool of the
+/// 		topic, else SUCCESS.
+///
+exception	publish( topic* pTopic, void* pBuffer );
+
+///
+/// @fn	void* receive_publication( subscriber* pSub );
+///
+/// @brief	Blocks until a publication is available or the deadline
+/// 		of the calling task is reached. The buffer must be given
+/// 		back with release_buffer().
+/// @param	pSub	The subscriber.
+///
+/// @return	Null if the deadline was reached, else the buffer.
+///
+void*		receive_publication( subscriber* pSub );
+
+///
+/// @fn	exception release_buffer( topic* pTopic, void* pBuffer );
+///
+/// @brief	Releases a reference to a buffer, the buffer returns to the
+/// 		pool when the last reference is released. A claimed buffer
+/// 		that was never published can be given back the same way.
+/// @param	pTopic 	The topic.
+/// @param	pBuffer	The buffer.
+///
+/// @return	FAIL if the buffer is not held or not from the pool of the
+/// 		topic, else SUCCESS.
+///
+exception	release_buffer( topic* pTopic, void* pBuffer );
+
+//////////////////////////////////////////////////////////////////////////////
+///							Channel function prototypes.
+//////////////////////////////////////////////////////////////////////////////
+
+///
+/// @fn	channel* create_channel( uint nDataSize );
+///
+/// @brief	Creates a latest-value channel.
+/// @param	nDataSize	The size in bytes of a value.
+///
+/// @return	Null if it fails, else the new channel.
+///
+channel*	create_channel( uint nDataSize );
+
+///
+/// @fn	exception remove_channel( channel* pChannel );
+///
+/// @brief	Removes a channel.
+/// @param	pChannel	The channel.
+///
+/// @return	FAIL or OK.
+///
+exception	remove_channel( channel* pChannel );
+
+///
+/// @fn	exception write_channel( channel* pChannel, void* pData );
+///
+/// Overwrites the value of the channel, never blocks, never allocates
+/// and never disables interrupts. A channel has a single writer, the 
+/// writer and the readers may be tasks or interrupt service routines.
+/// 
+/// @brief	Writes a value.
+/// @param	pChannel	The channel.
+/// @param	pData		The value.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception	write_channel( channel* pChannel, void* pData );
+
+///
+/// @fn	exception read_channel( channel* pChannel, void* pData );
+///
+/// Copies a consistent snapshot of the latest value without disabling 
+/// interrupts, the copy is retried if a write interleaved with it.
+/// 
+/// @brief	Reads the latest value.
+/// @param	pChannel	The channel.
+/// @param	pData		Receives the value.
+///
+/// @return	FAIL if nothing has been written yet, else SUCCESS.
+///
+exception	read_channel( channel* pChannel, void* pData );
+
+//////////////////////////////////////////////////////////////////////////////
+///							Mutex function prototypes.
+//////////////////////////////////////////////////////////////////////////////
+
+///
+/// @fn	mutex* create_mutex( uint nCeiling );
+///
+/// @brief	Creates a mutex.
+/// @param	nCeiling	The shortest relative deadline of the tasks that lock the mutex.
+///
+/// @return	Null if it fails, else the new mutex.
+///
+mutex*		create_mutex( uint nCeiling );
+
+///
+/// @fn	exception remove_mutex( mutex* pMutex );
+///
+/// @brief	Removes a mutex that is not locked.
+/// @param	pMutex	The mutex.
+///
+/// @return	FAIL if the mutex is locked, else OK.
+///
+exception	remove_mutex( mutex* pMutex );
+
+///
+/// @fn	exception lock_mutex( mutex* pMutex );
+///
+/// Locks the mutex and raises the system ceiling, never blocks.
+/// Mutexes must be unlocked in the reverse order they were locked.
+/// 
+/// @brief	Locks a mutex.
+/// @param	pMutex	The mutex.
+///
+/// @return	FAIL if the mutex is taken or its ceiling is lower than the
+/// 		preemption level of the calling task, else SUCCESS.
+///
+exception	lock_mutex( mutex* pMutex );
+
+///
+/// @fn	exception unlock_mutex( mutex* pMutex );
+///
+/// Unlocks the mutex and restores the system ceiling, tasks that were
+/// held back by the ceiling may preempt the calling task.
+/// 
+/// @brief	Unlocks a mutex.
+/// @param	pMutex	The mutex.
+///
+/// @return	FAIL if the calling task does not own the mutex or has locked
+/// 		another mutex after it, else SUCCESS.
+///
+exception	unlock_mutex( mutex* pMutex );
+
+
 //////////////////////////////////////////////////////////////////////////////
 ///							Timing function prototypes.
 //////////////////////////////////////////////////////////////////////////////
@@ -283,6 +991,23 @@ int         receive_no_wait( mailbox* mBox, void* pData );
 ///
 exception	wait( uint nTicks );
 
+///
+/// @fn	exception wait_slack( uint nTicks, uint nSlack );
+///
+/// Like wait() but the task may be woken up to nSlack ticks late, it is 
+/// woken together with a task that already waits for a tick within the
+/// window so that both are released by a single scheduling pass. The 
+/// slack is cut so that the task is woken before its deadline.
+///
+/// @brief	Waits for nTicks with a slack of nSlack ticks.
+/// @param	nTicks	Waiting period.
+/// @param	nSlack	The ticks the wake-up may be postponed.
+///
+/// @return	FAIL if nTicks is 0, DEADLINE_REACHED if the deadline was 
+/// 		reached while waiting else SUCCESS.
+///
+exception	wait_slack( uint nTicks, uint nSlack );
+
 ///
 /// @fn	void set_ticks( uint no_of_ticks );
 ///
@@ -327,6 +1052,50 @@ uint		deadline( void );
 ///
 void		set_deadline( uint nNew );
 
+///
+/// @fn	exception set_preemption_threshold( uint nThreshold, uint nClass );
+///
+/// While the calling task runs it is only preempted by tasks with a 
+/// deadline more than nThreshold ticks earlier than its own or by tasks
+/// in a higher preemption class. A threshold of 0 is plain EDF.
+///
+/// @brief	Sets the preemption threshold of the current task.
+///
+/// @param	nThreshold	The threshold in ticks.
+/// @param	nClass	  	The preemption class.
+///
+/// @return	FAIL if there is no running task else SUCCESS.
+///
+exception	set_preemption_threshold( uint nThreshold, uint nClass );
+
+///
+/// @fn	exception set_time_slice( uint nTicks );
+///
+/// Tasks whose deadlines are equal take turns every nTicks ticks, the
+/// initial length is TIME_SLICE_TICKS.
+///
+/// @brief	Sets the length of a time slice.
+///
+/// @param	nTicks	The length in ticks, 0 disables time slicing.
+///
+/// @return	SUCCESS.
+///
+exception	set_time_slice( uint nTicks );
+
+///
+/// @fn	exception set_priority( uint nPriority );
+///
+/// Only used by the SCHED_FP policy, tasks are created with the priority
+/// SCHED_PRIORITIES - 2 and the idle task has the lowest priority.
+///
+/// @brief	Sets the priority of the current task.
+///
+/// @param	nPriority	The priority, 0 is the highest.
+///
+/// @return	FAIL if the priority is out of range else SUCCESS.
+///
+exception	set_priority( uint nPriority );
+
 //////////////////////////////////////////////////////////////////////////////
 ///					Context related function prototypes.
 //////////////////////////////////////////////////////////////////////////////
@@ -334,6 +1103,11 @@ void		set_deadline( uint nNew );
 ///
 /// @fn	extern void isr_off(void);
 ///
+/// Enters a kernel critical section. Critical sections nest, interrupts
+/// are enabled again when the outermost critical section is left.
+/// On Cortex-M only interrupts at or below KERNEL_INTERRUPT_PRIORITY are 
+/// masked (BASEPRI), more urgent interrupts keep their latency.
+/// 
 /// @brief	Disables interrupts.
 ///
 extern void     isr_off(void);
@@ -341,6 +1115,9 @@ extern void     isr_off(void);
 ///
 /// @fn	extern void isr_on(void);
 ///
+/// Leaves a kernel critical section, interrupts are only enabled
+/// when the outermost critical section is left.
+/// 
 /// @brief	Enables interrupts.
 ///
 extern void     isr_on(void);
@@ -358,6 +1135,15 @@ extern void SaveContext(void);
 /// @brief	Loads the context.
 ///
 extern void LoadContext(void);
+
+///
+/// @fn	extern void PreemptTrampoline(void);
+///
+/// @brief	Saves the registers of a task that the tick interrupt has 
+/// 		redirected, calls kernelPreempt() and resumes the task where
+/// 		it was interrupted.
+///
+extern void PreemptTrampoline(void);
 	
 #ifdef __cplusplus
 }
@@ -46,6 +46,20 @@ void OSList_create_test(void);
 ///
 void OSList_timerInsert_test(void);
 
+///
+/// @fn	void OSList_timerInsertAt_test(void);
+///
+/// @brief	Tests operating system list timer insert at an absolute tick.
+///
+void OSList_timerInsertAt_test(void);
+
+///
+/// @fn	void OSList_timerInsertSlack_test(void);
+///
+/// @brief	Tests operating system list timer insert with slack.
+///
+void OSList_timerInsertSlack_test(void);
+
 ///
 /// @fn	void OSList_deadlineInsert_test(void);
 ///
@@ -56,6 +70,34 @@ void OSList_timerInsert_test(void);
 ///
 void OSList_deadlineInsert_test(void);
 
+///
+/// @fn	void OSList_levelInsert_test(void);
+///
+/// @brief	Tests operating system list deadline monotonic insert.
+///
+void OSList_levelInsert_test(void);
+
+///
+/// @fn	void OSList_deadlineReposition_test(void);
+///
+/// @brief	Tests operating system list deadline reposition.
+///
+void OSList_deadlineReposition_test(void);
+
+///
+/// @fn	void OSList_priorityInsert_test(void);
+///
+/// @brief	Tests operating system list fixed priority insert and remove.
+///
+void OSList_priorityInsert_test(void);
+
+///
+/// @fn	void OSList_frontInsert_test(void);
+///
+/// @brief	Tests operating system list front insert.
+///
+void OSList_frontInsert_test(void);
+
 ///
 /// @fn	void OSList_getFirst_test(void);
 ///
@@ -35,6 +35,13 @@
 
 
 
+// Asserts EDF behaviour, SCHED_POLICY must be SCHED_EDF
 void kernel_test_run(void);
 
+// Runs the kernel in the time-triggered mode, an alternative to
+// kernel_test_run() since the mode is chosen before run()
+void kernel_tt_test_run(void);
+// Runs the fixed priority dispatch test, SCHED_POLICY must be SCHED_FP
+void kernel_fp_test_run(void);
+
 #endif // _KERNEL_TEST_H_
\ No newline at end of file
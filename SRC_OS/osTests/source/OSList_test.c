@@ -38,7 +38,13 @@ void OSList_runTests(void)
 	// Run tests
 	OSList_create_test();
 	OSList_timerInsert_test();
+	OSList_timerInsertAt_test();
+	OSList_timerInsertSlack_test();
 	OSList_deadlineInsert_test();
+	OSList_levelInsert_test();
+	OSList_deadlineReposition_test();
+	OSList_priorityInsert_test();
+	OSList_frontInsert_test();
 	OSList_getFirst_test();
 	OSList_remove_test();
 }
@@ -337,6 +343,343 @@ void OSList_deadlineInsert_test(void)
 	isr_on();
 }
 
+///
+/// @fn	void OSList_timerInsertAt_test(void);
+///
+/// @brief	Tests operating system list timer insert at an absolute tick.
+///
+void OSList_timerInsertAt_test(void)
+{
+	// Create the list.
+	OSList_t* list = OSList_create();
+	assert(list != NULL);
+
+	// Try to pass a NULL pointer
+	assert(!OSList_timerInsertAt(list, NULL, 10));
+	assert(list->size == 0);
+
+	// The release tick is used as is
+	listobj* ob20 = OSList_createListobj();
+	listobj* ob10 = OSList_createListobj();
+	listobj* ob15 = OSList_createListobj();
+	assert(OSList_timerInsertAt(list, ob20, ticks() + 20));
+	assert(OSList_timerInsertAt(list, ob10, ticks() + 10));
+	assert(OSList_timerInsertAt(list, ob15, ticks() + 15));
+	assert(ob15->nTCnt == ticks() + 15);
+	assert(list->size == 3);
+
+	// The list is sorted by release tick
+	assert(OSList_getFirst(list) == ob10);
+	assert(OSList_getFirst(list) == ob15);
+	assert(OSList_getFirst(list) == ob20);
+
+	// Clean up after test
+	free(ob10->pTask);
+	free(ob10);
+	free(ob15->pTask);
+	free(ob15);
+	free(ob20->pTask);
+	free(ob20);
+	free(list);
+}
+
+///
+/// @fn	void OSList_timerInsertSlack_test(void);
+///
+/// @brief	Tests operating system list timer insert with slack.
+///
+void OSList_timerInsertSlack_test(void)
+{
+	// Create the list.
+	OSList_t* list = OSList_create();
+	assert(list != NULL);
+
+	// Try to pass a NULL pointer
+	assert(!OSList_timerInsertSlack(list, NULL, 10, 5));
+	assert(list->size == 0);
+
+	listobj* ob20 = OSList_createListobj();
+	listobj* ob12 = OSList_createListobj();
+	listobj* ob17 = OSList_createListobj();
+	listobj* ob30 = OSList_createListobj();
+
+	// Nothing to share with, released at the earliest tick
+	assert(OSList_timerInsertSlack(list, ob20, 20, 5));
+	assert(ob20->nTCnt == 20);
+
+	// The release at 20 is outside the window
+	assert(OSList_timerInsertSlack(list, ob12, 12, 5));
+	assert(ob12->nTCnt == 12);
+
+	// Shares the release at 20 rather than adding one at 17
+	assert(OSList_timerInsertSlack(list, ob17, 17, 5));
+	assert(ob17->nTCnt == 20);
+
+	// Without slack the tick is used as is
+	assert(OSList_timerInsertSlack(list, ob30, 30, 0));
+	assert(ob30->nTCnt == 30);
+	assert(list->size == 4);
+
+	// The list is sorted by release tick
+	assert(OSList_getFirst(list) == ob12);
+	assert(OSList_getFirst(list) == ob20);
+	assert(OSList_getFirst(list) == ob17);
+	assert(OSList_getFirst(list) == ob30);
+
+	// Clean up after test
+	free(ob20->pTask);
+	free(ob20);
+	free(ob12->pTask);
+	free(ob12);
+	free(ob17->pTask);
+	free(ob17);
+	free(ob30->pTask);
+	free(ob30);
+	free(list);
+}
+
+///
+/// @fn	void OSList_levelInsert_test(void);
+///
+/// @brief	Tests operating system list deadline monotonic insert.
+///
+void OSList_levelInsert_test(void)
+{
+	// Create the list.
+	OSList_t* list = OSList_create();
+	assert(list != NULL);
+
+	// Try to pass a NULL pointer
+	assert(!OSList_levelInsert(list, NULL));
+	assert(list->size == 0);
+
+	listobj* ob20 = OSList_createListobj();
+	listobj* ob10a = OSList_createListobj();
+	listobj* ob10b = OSList_createListobj();
+	listobj* ob5 = OSList_createListobj();
+	ob20->nRelDeadline = 20;
+	ob10a->nRelDeadline = 10;
+	ob10b->nRelDeadline = 10;
+	ob5->nRelDeadline = 5;
+	assert(OSList_levelInsert(list, ob20));
+	assert(OSList_levelInsert(list, ob10a));
+	assert(OSList_levelInsert(list, ob10b));
+	assert(OSList_levelInsert(list, ob5));
+	assert(list->size == 4);
+
+	// Sorted by relative deadline, FIFO among equals
+	assert(OSList_getFirst(list) == ob5);
+	assert(OSList_getFirst(list) == ob10a);
+	assert(OSList_getFirst(list) == ob10b);
+	assert(OSList_getFirst(list) == ob20);
+
+	// Clean up after test
+	free(ob20->pTask);
+	free(ob20);
+	free(ob10a->pTask);
+	free(ob10a);
+	free(ob10b->pTask);
+	free(ob10b);
+	free(ob5->pTask);
+	free(ob5);
+	free(list);
+}
+
+///
+/// @fn	void OSList_deadlineReposition_test(void);
+///
+/// @brief	Tests operating system list deadline reposition.
+///
+void OSList_deadlineReposition_test(void)
+{
+	// Create the list.
+	OSList_t* list = OSList_create();
+	assert(list != NULL);
+
+	// Try to pass a NULL pointer
+	assert(!OSList_deadlineReposition(list, NULL));
+
+	listobj* ob10 = OSList_createListobj();
+	listobj* ob20 = OSList_createListobj();
+	listobj* ob30 = OSList_createListobj();
+	ob10->pTask->DeadLine = 10;
+	ob20->pTask->DeadLine = 20;
+	ob30->pTask->DeadLine = 30;
+	assert(OSList_deadlineInsert(list, ob10));
+	assert(OSList_deadlineInsert(list, ob20));
+	assert(OSList_deadlineInsert(list, ob30));
+
+	// Unchanged order
+	ob20->pTask->DeadLine = 25;
+	assert(OSList_deadlineReposition(list, ob20));
+	assert(list->pHead == ob10 && ob10->pNext == ob20 && ob20->pNext == ob30);
+
+	// The head moves to the tail, behind an equal deadline
+	ob10->pTask->DeadLine = 30;
+	assert(OSList_deadlineReposition(list, ob10));
+	assert(list->pHead == ob20 && ob20->pNext == ob30 && ob30->pNext == ob10);
+	assert(list->pTail == ob10 && ob10->pNext == NULL && ob10->pPrevious == ob30);
+
+	// The tail moves to the head
+	ob10->pTask->DeadLine = 5;
+	assert(OSList_deadlineReposition(list, ob10));
+	assert(list->pHead == ob10 && ob10->pPrevious == NULL && ob10->pNext == ob20);
+	assert(list->pTail == ob30 && ob30->pNext == NULL && ob30->pPrevious == ob20);
+	assert(list->size == 3);
+
+	// Clean up after test
+	free(ob10->pTask);
+	free(ob10);
+	free(ob20->pTask);
+	free(ob20);
+	free(ob30->pTask);
+	free(ob30);
+	free(list);
+}
+
+///
+/// @fn	void OSList_priorityInsert_test(void);
+///
+/// @brief	Tests operating system list fixed priority insert and remove.
+///
+void OSList_priorityInsert_test(void)
+{
+	// Create the list.
+	OSList_t* list = OSList_create();
+	assert(list != NULL);
+
+	// Try to pass a NULL pointer or a priority out of range
+	listobj* obBad = OSList_createListobj();
+	obBad->nPriority = SCHED_PRIORITIES;
+	assert(!OSList_priorityInsert(list, NULL));
+	assert(!OSList_priorityInsert(list, obBad));
+	assert(list->size == 0);
+
+	listobj* ob31 = OSList_createListobj();
+	listobj* ob3a = OSList_createListobj();
+	listobj* ob3b = OSList_createListobj();
+	listobj* ob0 = OSList_createListobj();
+	listobj* ob7 = OSList_createListobj();
+	ob31->nPriority = 31;
+	ob3a->nPriority = 3;
+	ob3b->nPriority = 3;
+	ob0->nPriority = 0;
+	ob7->nPriority = 7;
+	assert(OSList_priorityInsert(list, ob31));
+	assert(OSList_priorityInsert(list, ob3a));
+	assert(OSList_priorityInsert(list, ob0));
+	assert(OSList_priorityInsert(list, ob3b));
+	assert(OSList_priorityInsert(list, ob7));
+	assert(list->size == 5);
+
+	// Sorted by priority, FIFO among equals
+	assert(list->pHead == ob0);
+	assert(ob0->pNext == ob3a);
+	assert(ob3a->pNext == ob3b);
+	assert(ob3b->pNext == ob7);
+	assert(ob7->pNext == ob31);
+	assert(list->pTail == ob31);
+
+	// Removing the last task of a priority keeps the order of later inserts
+	assert(OSList_priorityRemove(list, ob3b));
+	assert(!OSList_priorityRemove(list, ob3b));
+	assert(OSList_priorityRemove(list, ob0));
+	ob0->nPriority = 3;
+	assert(OSList_priorityInsert(list, ob0));
+	assert(ob3a->pNext == ob0);
+	assert(ob0->pNext == ob7);
+
+	// Empty the list, the bitmap is cleared for the next user
+	assert(OSList_priorityRemove(list, ob3a));
+	assert(OSList_priorityRemove(list, ob0));
+	assert(OSList_priorityRemove(list, ob7));
+	assert(OSList_priorityRemove(list, ob31));
+	assert(list->size == 0);
+	assert(OSList_priorityInsert(list, ob7));
+	assert(OSList_priorityInsert(list, ob31));
+	assert(list->pHead == ob7);
+
+	// Every list keeps its own priorities
+	OSList_t* other = OSList_create();
+	assert(other != NULL);
+	assert(OSList_priorityInsert(other, ob3a));
+	assert(OSList_priorityInsert(other, ob0));
+	assert(other->pHead == ob3a);
+	assert(ob3a->pNext == ob0);
+	assert(other->pTail == ob0);
+	assert(list->pHead == ob7);
+	assert(OSList_priorityRemove(other, ob3a));
+	assert(OSList_priorityRemove(other, ob0));
+	assert(other->priorityBitmap == 0);
+	assert(list->priorityBitmap == ((1UL << 7) | (1UL << 31)));
+	free(other);
+
+	assert(OSList_priorityRemove(list, ob7));
+	assert(OSList_priorityRemove(list, ob31));
+
+	// Clean up after test
+	free(obBad->pTask);
+	free(obBad);
+	free(ob31->pTask);
+	free(ob31);
+	free(ob3a->pTask);
+	free(ob3a);
+	free(ob3b->pTask);
+	free(ob3b);
+	free(ob0->pTask);
+	free(ob0);
+	free(ob7->pTask);
+	free(ob7);
+	free(list);
+}
+
+///
+/// @fn	void OSList_frontInsert_test(void);
+///
+/// @brief	Tests operating system list front insert.
+///
+void OSList_frontInsert_test(void)
+{
+	// Create the list.
+	OSList_t* list = OSList_create();
+	assert(list != NULL);
+
+	// Try to pass a NULL pointer
+	assert(!OSList_frontInsert(list, NULL));
+	assert(!OSList_frontInsert(NULL, OSList_createListobj()));
+	assert(list->size == 0);
+
+	// Insert into empty list
+	listobj* ob = OSList_createListobj();
+	assert(OSList_frontInsert(list, ob));
+	assert(list->size == 1);
+	assert(list->pHead == ob);
+	assert(list->pTail == ob);
+
+	// Insert another object, it should end up in front
+	// regardless of its deadline.
+	listobj* ob2 = OSList_createListobj();
+	ob2->pTask->DeadLine = 100;
+	assert(OSList_frontInsert(list, ob2));
+	assert(list->size == 2);
+	assert(list->pHead == ob2);
+	assert(list->pHead->pNext == ob);
+	assert(list->pTail == ob);
+	assert(ob->pPrevious == ob2);
+
+	// getFirst should return the objects in LIFO order
+	assert(OSList_getFirst(list) == ob2);
+	assert(OSList_getFirst(list) == ob);
+	assert(list->size == 0);
+
+	// Clean up after test
+	free(ob->pTask);
+	free(ob);
+	free(ob2->pTask);
+	free(ob2);
+	free(list);
+}
+
 ///
 /// @fn	void OSList_getFirst_test(void);
 ///
@@ -453,7 +796,18 @@ void OSList_remove_test(void)
 	// try to remove non-existant object
 	tmp = OSList_createListobj();
 	assert(OSList_remove(list, tmp) == false);
+
+	// try to remove an object that is in another list
+	OSList_t* other = OSList_create();
+	assert(other != NULL);
+	OSList_frontInsert(other, tmp);
+	assert(OSList_contains(other, tmp) && !OSList_contains(list, tmp));
+	assert(OSList_remove(list, tmp) == false);
+	assert(list->size == 100 && other->size == 1);
+	assert(OSList_remove(other, tmp) == true);
+	assert(!OSList_contains(other, tmp));
 	free(tmp);
+	free(other);
 
 	// Try to remove head
 	tmp = list->pHead;
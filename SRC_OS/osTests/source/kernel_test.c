@@ -29,11 +29,64 @@
 void task01(void);
 void task02(void);
 void task03(void);
+void rpcServer(void);
+void rpcDropper(void);
+void periodicTask(void);
+void ttFirstSlot(void);
+void ttSlot(void);
+void ttLateSlot(void);
+void cbsTask(void);
+void overrunTask(void);
+void skipTask(void);
+void demoteTask(void);
+void handlerTask(void);
+uint overrunHandler(listobj* pTask);
+void admittedTask(void);
+void thresholdTask(void);
+void lockerTask(void);
+void notifyWaiter(void);
+void sliceWorker(void);
+bool idleHook(void);
+void fpTask(void);
+void fpLowTask(void);
+#ifdef _CORTEX_M_FPU_
+void fpuTask01(void);
+void fpuTask02(void);
+#endif
 
 //////////////////////////////////////////////////////////////////////////////
 ///							Private variables
 //////////////////////////////////////////////////////////////////////////////
 static mailbox* mb;
+static mailbox* rpcBox;
+static mailbox* dropBox;
+static uint periodicStart;
+static volatile uint periodicJobs = 0;
+static volatile bool cbsPostponed = false;
+static volatile bool cbsSpinning = false;
+static volatile bool cbsReleased = false;
+static volatile uint overrunRuns = 0;
+static volatile uint skipRuns = 0;
+static volatile uint skipRestart = 0;
+static volatile bool demoteReleased = false;
+static volatile bool demoteDone = false;
+static volatile uint handlerCalls = 0;
+static volatile bool handlerReleased = false;
+static volatile bool handlerDone = false;
+static volatile bool admissionDone = false;
+static volatile bool thresholdRan = false;
+static mutex* lockerMutex;
+static listobj* notifyWaiterTask = NULL;
+static volatile exception notifyWaiterResult = FAIL;
+static volatile uint sliceWorkers = 0;
+static ttslot ttTable[4] = { { 0, ttFirstSlot }, { 1, ttSlot }, { 2, ttSlot }, { 6, ttLateSlot } };
+static volatile bool ttStarted = false;
+static uint ttStart;
+static volatile uint ttRuns = 0;
+static uint ttPasses = 0;
+static volatile uint idleHookCalls = 0;
+static volatile uint idleHookRuns = 0;
+static volatile uint fpLowRuns = 0;
 
 //////////////////////////////////////////////////////////////////////////////
 ///							Function definitions
@@ -74,16 +127,57 @@ void kernel_test_run(void)
 	assert(create_task(NULL, 10) == FAIL);
 	puts("-		OK!");
 	
+	puts("- registering idle hooks ...");
+	assert(add_idle_hook(NULL, 1) == FAIL);
+	assert(add_idle_hook(idleHook, 0) == FAIL);
+	assert(add_idle_hook(idleHook, 1) == SUCCESS);
+	puts("-		OK!");
+
 	puts("- properly creating a task ...");
 	// Properly create task
 	assert(create_task(task01, 100) == SUCCESS);
 	puts("-		OK!");
 
+	puts("- testing set_time_triggered() with bad arguments ...");
+	assert(set_time_triggered(NULL, 2, 10) == FAIL);
+	assert(set_time_triggered(ttTable, 4, 5) == FAIL);	// Offset outside of hyperperiod
+	assert(set_time_triggered(ttTable, 4, 10) == FAIL);	// EDF tasks have been created
+	puts("-		OK!");
+
+#ifdef _CORTEX_M_FPU_
+	puts("- creating two tasks that use the FPU ...");
+	// The FPU tasks interleave while keeping values
+	// in FPU registers, they are run while task01 is blocked.
+	assert(create_task(fpuTask01, 200) == SUCCESS);
+	assert(create_task(fpuTask02, 200) == SUCCESS);
+	puts("-		OK!");
+#endif
+
 	puts("Now call run()");
 	// Branch to task01
 	run();
 }
 
+void kernel_tt_test_run(void)
+{
+	puts("- testing the time-triggered mode ...");
+	assert(init_kernel() == SUCCESS);
+	assert(set_time_triggered(ttTable, 4, 10) == SUCCESS);
+	assert(create_task(task01, 100) == FAIL);	// No EDF tasks in this mode
+	run();
+}
+
+void kernel_fp_test_run(void)
+{
+	assert(SCHED_POLICY == SCHED_FP);
+	puts("- testing the fixed priority dispatch ...");
+	assert(init_kernel() == SUCCESS);
+	assert(create_cbs_task(cbsTask, 2, 10) == FAIL);	// EDF only
+	assert(create_admitted_task(admittedTask, 1, 10, 10, 0) == FAIL);
+	assert(create_task(fpTask, 100) == SUCCESS);
+	run();
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //								Tasks
 //////////////////////////////////////////////////////////////////////////////
@@ -146,6 +240,288 @@ void task01(void)
 	// Display received message
 	puts(recMsg);
 
+	puts("- testing that the idle task runs its hooks ...");
+	// Both tasks are waiting so the idle task gets to run
+	wait(10);
+	assert(idleHookCalls > 0);
+	assert(idleHookRuns == 1);		// Not polled again after it had no work
+	assert(arm_idle_hook(idleHook) == SUCCESS);
+	wait(10);
+	assert(idleHookRuns == 2);
+	assert(remove_idle_hook(idleHook) == SUCCESS);
+	assert(arm_idle_hook(idleHook) == FAIL);
+	assert(remove_idle_hook(idleHook) == FAIL);
+	puts("-		OK!");
+
+	puts("- testing mutexes ...");
+	assert(create_mutex(0) == NULL);
+	mutex* mtx = create_mutex(5);
+	assert(mtx != NULL);
+	assert(lock_mutex(mtx) == SUCCESS);
+	assert(lock_mutex(mtx) == FAIL);		// Already locked
+	assert(remove_mutex(mtx) == FAIL);		// Cannot remove a locked mutex
+	assert(unlock_mutex(mtx) == SUCCESS);
+	assert(unlock_mutex(mtx) == FAIL);		// Not the owner anymore
+	assert(remove_mutex(mtx) == OK);
+	mutex* mtx2 = create_mutex(5);
+	assert((mtx = create_mutex(5)) != NULL && mtx2 != NULL);
+	assert(lock_mutex(mtx) == SUCCESS);
+	assert(lock_mutex(mtx2) == SUCCESS);
+	assert(unlock_mutex(mtx) == FAIL);		// Not in reverse order
+	assert(unlock_mutex(mtx2) == SUCCESS);
+	assert(unlock_mutex(mtx) == SUCCESS);
+	assert(remove_mutex(mtx2) == OK);
+	lockerMutex = mtx;
+	set_deadline(ticks() + 100);
+	assert(create_task(lockerTask, ticks() + 5) == SUCCESS);	// Terminates holding the mutex
+	assert(lock_mutex(mtx) == SUCCESS);		// Unlocked by terminate()
+	assert(unlock_mutex(mtx) == SUCCESS);
+	assert(remove_mutex(mtx) == OK);
+	puts("-		OK!");
+
+	puts("- testing semaphores ...");
+	semaphore* sem = create_semaphore(1);
+	assert(sem != NULL);
+	assert(take_no_wait(sem) == SUCCESS);
+	assert(take_no_wait(sem) == FAIL);		// No tokens left
+	assert(give_semaphore(sem) == SUCCESS);
+	assert(take_wait(sem) == SUCCESS);		// Will not block
+	set_deadline(ticks() + 5);
+	assert(take_wait(sem) == DEADLINE_REACHED);	// Blocks until the deadline
+	assert(give_semaphore_isr(sem) == SUCCESS);
+	assert(take_no_wait(sem) == SUCCESS);
+	assert(remove_semaphore(sem) == OK);
+	puts("-		OK!");
+
+	puts("- testing task notifications ...");
+	uint nValue = 0;
+	assert(notify(NULL, 1, NOTIFY_SET_BITS) == FAIL);
+	assert(notify(current_task(), 0x5, NOTIFY_SET_BITS) == SUCCESS);
+	assert(notify_wait(0x4, true, &nValue) == SUCCESS);	// Bits are already set
+	assert(nValue == 0x5);
+	assert(notify_wait(0x1, false, &nValue) == SUCCESS);	// 0x4 was cleared on exit
+	assert(nValue == 0x1);
+	assert(notify(current_task(), 0, NOTIFY_OVERWRITE) == SUCCESS);
+	set_deadline(ticks() + 5);
+	assert(notify_wait(0x1, true, NULL) == DEADLINE_REACHED);
+	assert(notify_isr(current_task(), 0, NOTIFY_INCREMENT) == SUCCESS);
+	assert(notify_wait(0x1, true, &nValue) == SUCCESS);
+	assert(nValue == 1);
+	set_deadline(ticks() + 100);
+	uint nWaiterDeadline = ticks() + 10;
+	assert(create_task(notifyWaiter, nWaiterDeadline) == SUCCESS);	// Blocks in notify_wait()
+	set_deadline(ticks() + 5);
+	while (ticks() <= nWaiterDeadline);	// The waiter is released to the readyList
+	assert(notify(notifyWaiterTask, 0x1, NOTIFY_SET_BITS) == SUCCESS);	// Must not insert it twice
+	set_deadline(ticks() + 100);		// The waiter runs and terminates
+	assert(notifyWaiterResult == SUCCESS);
+	puts("-		OK!");
+
+	puts("- testing event groups ...");
+	eventgroup* events = create_event_group();
+	assert(events != NULL);
+	assert(wait_event_bits(events, 0, false, false, NULL) == FAIL);
+	assert(set_event_bits(events, 0x3) == SUCCESS);
+	assert(wait_event_bits(events, 0x6, false, false, &nValue) == SUCCESS);	// Any
+	assert(nValue == 0x3);
+	assert(wait_event_bits(events, 0x3, true, true, &nValue) == SUCCESS);	// All
+	set_deadline(ticks() + 5);
+	assert(wait_event_bits(events, 0x1, false, false, NULL) == DEADLINE_REACHED);	// Cleared on exit
+	assert(set_event_bits_isr(events, 0x4) == SUCCESS);
+	assert(clear_event_bits(events, 0x4) == SUCCESS);
+	assert(events->nBits == 0);
+	assert(remove_event_group(events) == OK);
+	puts("-		OK!");
+
+	puts("- testing to block on several mailboxes (receive_any()) until deadline is reached ...");
+	mailbox* set[2] = { create_mailbox(1, sizeof(uint)), create_mailbox(1, sizeof(uint)) };
+	assert(set[0] != NULL && set[1] != NULL);
+	assert(receive_any(set, 0, &nValue, NULL) == FAIL);
+	assert(receive_any(set, MAX_RECEIVE_ANY + 1, &nValue, NULL) == FAIL);
+	set_deadline(ticks() + 5);
+	assert(receive_any(set, 2, &nValue, NULL) == DEADLINE_REACHED);
+	assert(no_messages(set[0]) == 0 && no_messages(set[1]) == 0);	// Left both mailboxes
+	puts("-		OK!");
+
+	puts("- testing to block with a timeout that expires before the deadline ...");
+	set_deadline(ticks() + 100);
+	uint nDeadline = deadline();
+	uint nStart = ticks();
+	assert(receive_wait_timeout(set[0], &nValue, 0) == FAIL);
+	assert(receive_wait_timeout(set[0], &nValue, 3) == TIMEOUT_REACHED);
+	assert(ticks() >= nStart + 3);
+	assert(send_wait_timeout(set[1], &nValue, 3) == TIMEOUT_REACHED);
+	assert(deadline() == nDeadline);	// The deadline was left untouched
+	assert(no_messages(set[0]) == 0 && no_messages(set[1]) == 0);
+	remove_mailbox(set[0]);
+	remove_mailbox(set[1]);
+	puts("-		OK!");
+
+	puts("- testing publish/subscribe topics ...");
+	topic* tp = create_topic(1, sizeof(uint));
+	assert(tp != NULL);
+	subscriber* sub1 = subscribe(tp, 2);
+	subscriber* sub2 = subscribe(tp, 2);
+	assert(sub1 != NULL && sub2 != NULL);
+	uint* pBuf = (uint*)claim_buffer(tp);
+	assert(pBuf != NULL);
+	assert(claim_buffer(tp) == NULL);			// The pool is empty
+	*pBuf = 42;
+	assert(publish(tp, pBuf) == SUCCESS);
+	assert(receive_publication(sub1) == pBuf);	// Both receive the same buffer
+	assert(receive_publication(sub2) == pBuf);
+	assert(release_buffer(tp, pBuf) == SUCCESS);
+	assert(claim_buffer(tp) == NULL);			// Still held by one subscriber
+	assert(release_buffer(tp, pBuf) == SUCCESS);
+	assert(release_buffer(tp, pBuf) == FAIL);	// Already back in the pool
+	assert(publish(tp, pBuf) == FAIL);
+	assert(release_buffer(tp, pBuf + 1) == FAIL);	// Not a buffer
+	assert((pBuf = (uint*)claim_buffer(tp)) != NULL);
+	assert(release_buffer(tp, pBuf) == SUCCESS);	// Unpublished claim
+	assert((pBuf = (uint*)claim_buffer(tp)) != NULL);
+	assert(publish(tp, pBuf) == SUCCESS);
+	assert(remove_topic(tp) == NOT_EMPTY);
+	assert(unsubscribe(sub1) == OK);			// Releases the queued publication
+	assert(unsubscribe(sub2) == OK);
+	assert(claim_buffer(tp) == pBuf);
+	assert(remove_topic(tp) == NOT_EMPTY);		// The buffer is claimed
+	assert(release_buffer(tp, pBuf) == SUCCESS);
+	assert(remove_topic(tp) == OK);
+	puts("-		OK!");
+
+	puts("- testing latest-value channels ...");
+	channel* ch = create_channel(sizeof(uint));
+	assert(ch != NULL);
+	assert(read_channel(ch, &nValue) == FAIL);	// Nothing written yet
+	nValue = 1;
+	assert(write_channel(ch, &nValue) == SUCCESS);
+	nValue = 2;
+	assert(write_channel(ch, &nValue) == SUCCESS);	// Overwrites, never blocks
+	nValue = 0;
+	assert(read_channel(ch, &nValue) == SUCCESS);
+	assert(nValue == 2);
+	for (uint i = 3; i < 8; i++)
+	{ // Every write goes through both copies
+		assert(write_channel(ch, &i) == SUCCESS);
+		nValue = 0;
+		assert(read_channel(ch, &nValue) == SUCCESS);
+		assert(nValue == i);
+		assert(read_channel(ch, &nValue) == SUCCESS);	// Reading does not consume
+		assert(nValue == i);
+	}
+	assert(remove_channel(ch) == OK);
+	puts("-		OK!");
+
+	puts("- testing call()/reply() ...");
+	uint nRequest = 21;
+	assert(reply(&nValue) == FAIL);		// No call is being handled
+	set_deadline(ticks() + 100);
+	assert((rpcBox = create_mailbox(1, sizeof(uint))) != NULL);
+	assert(create_task(rpcServer, ticks() + 200) == SUCCESS);
+	assert(call(rpcBox, &nRequest, &nValue) == SUCCESS);	// Queued until the server receives
+	assert(nValue == 42);
+	wait(1);								// The server blocks in receive_wait()
+	assert(rpcBox->nBlockedMsg < 0);
+	nRequest = 5;
+	assert(call(rpcBox, &nRequest, &nValue) == SUCCESS);	// Handed directly to the waiting server
+	assert(nValue == 10);
+	assert((dropBox = create_mailbox(1, sizeof(uint))) != NULL);
+	assert(create_task(rpcDropper, ticks() + 200) == SUCCESS);
+	assert(call(dropBox, &nRequest, &nValue) == NO_REPLY);	// The server terminated
+	assert(remove_mailbox(dropBox) == OK);
+	puts("-		OK!");
+
+	puts("- testing periodic tasks ...");
+	assert(wait_next_period() == FAIL);		// Not a periodic task
+	periodicStart = ticks();
+	assert(create_periodic_task(periodicTask, 10, 5, 0) == SUCCESS);
+	wait(35);
+	assert(periodicJobs == 3);
+	puts("-		OK!");
+
+	puts("- testing constant bandwidth servers ...");
+	assert(create_cbs_task(cbsTask, 0, 10) == FAIL);
+	assert(create_cbs_task(cbsTask, 11, 10) == FAIL);	// Budget larger than period
+	set_deadline(ticks() + 15);
+	assert(create_cbs_task(cbsTask, 2, 10) == SUCCESS);	// Runs at once, earlier deadline
+	assert(cbsSpinning);			// Postponed behind this task when its budget ran out
+	cbsReleased = true;
+	set_deadline(ticks() + 100);
+	assert(!cbsSpinning);
+	assert(cbsPostponed);
+	puts("-		OK!");
+
+	puts("- testing overrun policies ...");
+	assert(set_overrun_policy(OVERRUN_SKIP, NULL) == FAIL);		// Not a periodic task
+	assert(set_overrun_policy(OVERRUN_HANDLER, NULL) == FAIL);
+	set_deadline(ticks() + 100);
+	assert(create_task(overrunTask, ticks() + 3) == SUCCESS);	// Aborted once, then terminates
+	assert(overrunRuns == 2);
+	uint nSkipStart = ticks();
+	assert(create_periodic_task(skipTask, 10, 3, 0) == SUCCESS);	// Skips its first job
+	wait(15);
+	assert(skipRuns == 2 && skipRestart >= nSkipStart + 10);
+	set_deadline(ticks() + 100);
+	assert(create_task(demoteTask, ticks() + 3) == SUCCESS);	// Runs behind this task after its deadline
+	assert(!demoteDone);
+	demoteReleased = true;
+	wait(2);
+	assert(demoteDone);
+	assert(create_task(handlerTask, ticks() + 3) == SUCCESS);	// The handler postpones its deadline
+	assert(handlerCalls == 1 && !handlerDone);
+	handlerReleased = true;
+	wait(2);
+	assert(handlerDone);
+	puts("-		OK!");
+
+	puts("- testing admission control ...");
+	assert(create_admitted_task(admittedTask, 0, 10, 10, 0) == FAIL);
+	assert(create_admitted_task(admittedTask, 5, 10, 10, 0) == SUCCESS);	// U = 0.5
+	assert(create_admitted_task(admittedTask, 6, 10, 10, 0) == FAIL);		// U = 1.1
+	assert(create_admitted_task(admittedTask, 4, 10, 5, 0) == SUCCESS);		// Density 1.3, demand test passes
+	assert(create_admitted_task(admittedTask, 2, 100, 3, 0) == FAIL);	// U < 1, demand of 6 at t = 5
+	assert(create_admitted_task(admittedTask, 1, 2 * ADMISSION_MAX_INTERVAL, 
+		ADMISSION_MAX_INTERVAL + 1, 0) == FAIL);	// Schedulable but too long to be checked
+	admissionDone = true;
+	wait(20);	// The admitted tasks terminate and release their utilization
+	assert(create_admitted_task(admittedTask, 10, 10, 10, 0) == SUCCESS);	// U = 1
+	wait(20);
+	assert(create_admitted_task(admittedTask, 1, 3, 3, 0) == SUCCESS);
+	assert(create_admitted_task(admittedTask, 1, 3, 3, 0) == SUCCESS);
+	assert(create_admitted_task(admittedTask, 1, 3, 3, 0) == SUCCESS);	// U = 1, each share rounded up
+	assert(create_admitted_task(admittedTask, 1, 1000, 1000, 0) == FAIL);
+	puts("-		OK!");
+
+	puts("- testing preemption thresholds ...");
+	set_deadline(ticks() + 100);
+	assert(set_preemption_threshold(50, 0) == SUCCESS);
+	assert(create_task(thresholdTask, ticks() + 60) == SUCCESS);	// Earlier by less than the threshold
+	assert(!thresholdRan);
+	assert(set_preemption_threshold(0, 0) == SUCCESS);			// Preempted at once
+	assert(thresholdRan);
+	puts("-		OK!");
+
+	puts("- testing time slicing ...");
+	assert(set_time_slice(2) == SUCCESS);
+	set_deadline(ticks() + 10);
+	uint nWorkerDeadline = ticks() + 100;
+	assert(create_task(sliceWorker, nWorkerDeadline) == SUCCESS);
+	assert(create_task(sliceWorker, nWorkerDeadline) == SUCCESS);
+	set_deadline(nWorkerDeadline + 100);	// The workers run, sharing the cpu
+	assert(sliceWorkers == 2);
+	assert(set_time_slice(TIME_SLICE_TICKS) == SUCCESS);
+	puts("-		OK!");
+
+	puts("- testing wait_slack() ...");
+	assert(wait_slack(0, 5) == FAIL);
+	uint nWaitStart = ticks();
+	assert(wait_slack(5, 3) == SUCCESS);
+	assert(ticks() >= nWaitStart + 5);
+	set_deadline(ticks() + 10);
+	assert(wait_slack(5, 100) == SUCCESS);	// The slack ends before the deadline
+	assert(ticks() < deadline());
+	puts("-		OK!");
+
 	while (true)
 	{
 		wait(10);
@@ -180,5 +556,241 @@ void task02(void)
 	}
 }
 
+void rpcServer(void)
+{
+	uint nRequest;
+
+	// Serve calls until the deadline is reached
+	while (receive_wait(rpcBox, &nRequest) == SUCCESS)
+	{
+		uint nOther;
+		assert(receive_wait(rpcBox, &nOther) == FAIL);	// Reply first
+		nRequest *= 2;
+		assert(reply(&nRequest) == SUCCESS);
+	}
 
+	terminate();
+}
+
+void rpcDropper(void)
+{
+	uint nRequest;
+
+	assert(receive_wait(dropBox, &nRequest) == SUCCESS);
+	terminate();	// The caller must not be stranded
+}
+
+void periodicTask(void)
+{
+	// Releases and deadlines follow the period without drift
+	for (uint i = 1; i <= 3; i++)
+	{
+		assert(deadline() == periodicStart + (i - 1) * 10 + 5);
+		assert(wait_next_period() == SUCCESS);
+		assert(ticks() >= periodicStart + i * 10);
+		periodicJobs++;
+	}
+
+	terminate();
+}
+
+void cbsTask(void)
+{
+	uint nDeadline = deadline();
+	uint nStart = ticks();
+
+	// Overrun the budget of two ticks without calling the kernel,
+	// task01 must run before it releases this task
+	cbsSpinning = true;
+	while (!cbsReleased && ticks() < nStart + 20);
+
+	cbsPostponed = deadline() > nDeadline;
+	cbsSpinning = false;
+	terminate();
+}
+
+void overrunTask(void)
+{
+	assert(set_overrun_policy(OVERRUN_ABORT, NULL) == SUCCESS);
+
+	if (++overrunRuns == 1)
+	{ // Overrun the deadline, the kernel restarts the body
+		while (true);
+	}
+
+	terminate();
+}
 
+void skipTask(void)
+{
+	assert(set_overrun_policy(OVERRUN_SKIP, NULL) == SUCCESS);
+
+	if (++skipRuns == 1)
+	{ // Overrun the deadline, the job is dropped
+		while (true);
+	}
+
+	skipRestart = ticks();	// Restarted at the next release
+	terminate();
+}
+
+void demoteTask(void)
+{
+	assert(set_overrun_policy(OVERRUN_DEMOTE, NULL) == SUCCESS);
+	while (!demoteReleased);
+	demoteDone = true;
+	terminate();
+}
+
+void handlerTask(void)
+{
+	assert(set_overrun_policy(OVERRUN_HANDLER, overrunHandler) == SUCCESS);
+	while (!handlerReleased);
+	handlerDone = true;
+	terminate();
+}
+
+uint overrunHandler(listobj* pTask)
+{
+	// Postpone the deadline behind the deadline of task01
+	handlerCalls++;
+	return ticks() + 200;
+}
+
+void admittedTask(void)
+{
+	while (!admissionDone)
+	{
+		wait_next_period();
+	}
+
+	terminate();
+}
+
+void notifyWaiter(void)
+{
+	notifyWaiterTask = current_task();
+	notifyWaiterResult = notify_wait(0x1, true, NULL);
+	terminate();
+}
+
+void lockerTask(void)
+{
+	assert(lock_mutex(lockerMutex) == SUCCESS);
+	terminate();
+}
+
+void thresholdTask(void)
+{
+	thresholdRan = true;
+	terminate();
+}
+
+void sliceWorker(void)
+{
+	// Spins until the other worker with the same deadline gets a slice
+	sliceWorkers++;
+	while (sliceWorkers < 2);
+
+	terminate();
+}
+
+void ttFirstSlot(void)
+{
+	if (!ttStarted)
+	{ // Overrun the slots at offset 1 and 2 in the first hyperperiod
+		ttStart = ticks();
+		ttStarted = true;
+		while (ticks() < ttStart + 3);
+	}
+}
+
+void ttSlot(void)
+{
+	// Both delayed slots run right after the first one
+	if (ttRuns < 2)
+	{
+		assert(ticks() == ttStart + 3);
+	}
+	ttRuns++;
+}
+
+void ttLateSlot(void)
+{
+	if (ttPasses++ == 0)
+	{ // Back on time after the delayed slots
+		assert(ttRuns == 2);
+		assert(ticks() == ttStart + 6);
+		puts("-		OK!");
+	}
+}
+
+bool idleHook(void)
+{
+	idleHookRuns++;
+
+	// Simulate background work that is split into steps
+	while (!idle_hook_expired())
+	{
+		idleHookCalls++;
+	}
+
+	return false; // No more work, let the idle task sleep
+}
+
+void fpTask(void)
+{
+	assert(set_overrun_policy(OVERRUN_DEMOTE, NULL) == FAIL);	// EDF only
+
+	// A task with an earlier deadline but a lower priority waits
+	assert(set_priority(10) == SUCCESS);
+	assert(create_task(fpLowTask, ticks() + 50) == SUCCESS);
+	assert(fpLowRuns == 0);
+	assert(set_priority(20) == SUCCESS);
+	assert(fpLowRuns == 0);
+
+	// Equal priorities run in FIFO order, fpLowTask was first
+	assert(set_priority(SCHED_PRIORITIES - 2) == SUCCESS);
+	assert(fpLowRuns == 1);
+	puts("-		OK!");
+
+	terminate();
+}
+
+void fpLowTask(void)
+{
+	fpLowRuns++;
+	terminate();
+}
+
+#ifdef _CORTEX_M_FPU_
+void fpuTask01(void)
+{
+	float acc = 0.0f;
+
+	for (int i = 1; i <= 10; i++)
+	{
+		acc += 0.5f;
+		wait(1); // Let fpuTask02 clobber the FPU registers
+		assert(acc == 0.5f * i);
+	}
+
+	puts("- fpuTask01 kept its FPU context ... OK!");
+	terminate();
+}
+
+void fpuTask02(void)
+{
+	float acc = 100.0f;
+
+	for (int i = 1; i <= 10; i++)
+	{
+		acc -= 0.25f;
+		wait(1); // Let fpuTask01 clobber the FPU registers
+		assert(acc == 100.0f - 0.25f * i);
+	}
+
+	puts("- fpuTask02 kept its FPU context ... OK!");
+	terminate();
+}
+#endif
@@ -80,10 +80,47 @@
 					element->pPrevious = object; \
 					
 
+///
+/// @def	highestBit(x);
+///
+/// @brief	The index of the most significant set bit of x, x must not be 0.
+/// 		Compiles to a count leading zeros instruction.
+///
+/// @param	x	The value.
+///
+#if defined(_MSC_VER)
+#define highestBit(x) bitScanReverse(x)
+#elif defined(__CC_ARM)
+#define highestBit(x) (31 - __clz(x))
+#else
+#define highestBit(x) (31 - __builtin_clz(x))
+#endif
+
 //////////////////////////////////////////////////////////////////////////////
 //							Includes
 //////////////////////////////////////////////////////////////////////////////
 #include "OSList.h"
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#ifdef _MSC_VER
+///
+/// @fn	static uint32_t bitScanReverse(uint32_t x)
+///
+/// @brief	The index of the most significant set bit of x.
+///
+/// @param	x	The value, not 0.
+///
+/// @return	The index.
+///
+static uint32_t bitScanReverse(uint32_t x)
+{
+	unsigned long nIndex;
+	_BitScanReverse(&nIndex, x);
+	return nIndex;
+}
+#endif
 
 //////////////////////////////////////////////////////////////////////////////
 //							Function definitions
@@ -133,7 +170,32 @@ bool OSList_timerInsert(OSList_t* list, listobj* element, uint delay)
 	}
 
 	// Calculate nTcnt
-	element->nTCnt = ticks() + delay;
+	return OSList_timerInsertAt(list, element, ticks() + delay);
+}
+
+///
+/// @fn	bool OSList_timerInsertAt(OSList_t* list, listobj* element, uint nTCnt);
+///
+/// Inserts a task into the timer list to be released at an absolute 
+/// tick, used for releases that must not drift.
+/// 
+/// @brief	Timer list insert at an absolute tick.
+///
+/// @param [in,out]	list   	If non-null, the list which to insert to.
+/// @param [in,out]	element	If non-null, the element to insert into the list.
+/// @param 		   	nTCnt  	The tick at which to release the given task.
+///
+/// @return	True if it succeeds, false if it fails.
+///
+bool OSList_timerInsertAt(OSList_t* list, listobj* element, uint nTCnt)
+{
+	// Check parameters
+	if (list == NULL || element == NULL)
+	{
+		return false;
+	}
+
+	element->nTCnt = nTCnt;
 
 	if (list->size == 0)
 	{
@@ -161,10 +223,49 @@ bool OSList_timerInsert(OSList_t* list, listobj* element, uint delay)
 
 
 	// Increment list size
+	element->pList = list;
 	list->size++;
 	return true;
 }
 
+///
+/// @fn	bool OSList_timerInsertSlack(OSList_t* list, listobj* element, uint nTCnt, uint nSlack);
+///
+/// Coalesces releases, a task that may be released late shares the 
+/// release of a task already in the list rather than adding another one.
+/// 
+/// @brief	Timer list insert with slack.
+///
+/// @param [in,out]	list   	If non-null, the list which to insert to.
+/// @param [in,out]	element	If non-null, the element to insert into the list.
+/// @param 		   	nTCnt  	The earliest tick at which to release the given task.
+/// @param 		   	nSlack 	The ticks the release may be postponed.
+///
+/// @return	True if it succeeds, false if it fails.
+///
+bool OSList_timerInsertSlack(OSList_t* list, listobj* element, uint nTCnt, uint nSlack)
+{
+	// Check parameters
+	if (list == NULL || element == NULL)
+	{
+		return false;
+	}
+
+	// Find the first release at or after nTCnt
+	listobj* tmp = list->pHead;
+	while (tmp != NULL && tmp->nTCnt < nTCnt)
+	{
+		tmp = tmp->pNext;
+	}
+
+	if (tmp != NULL && tmp->nTCnt - nTCnt <= nSlack)
+	{ // Share the release
+		nTCnt = tmp->nTCnt;
+	}
+
+	return OSList_timerInsertAt(list, element, nTCnt);
+}
+
 ///
 /// @fn	bool OSList_deadlineInsert(OSList_t* list, listobj* element);
 ///
@@ -216,6 +317,277 @@ bool OSList_deadlineInsert(OSList_t* list, listobj* element)
 
 
 	// Increment list size
+	element->pList = list;
+	list->size++;
+	return true;
+}
+
+///
+/// @fn	bool OSList_deadlineReposition(OSList_t* list, listobj* element);
+///
+/// Like OSList_deadlineInsert() the element is placed after the elements
+/// with the same deadline.
+/// 
+/// @brief	Repositions a listobject in place.
+///
+/// @param [in,out]	list   	If non-null, the list that contains the element.
+/// @param [in,out]	element	If non-null, the element.
+///
+/// @return	True if it succeeds, false if it fails.
+///
+bool OSList_deadlineReposition(OSList_t* list, listobj* element)
+{
+	// Check parameters
+	if (list == NULL || element == NULL || list->size == 0)
+	{
+		return false;
+	}
+
+	uint nDeadline = element->pTask->DeadLine;
+	listobj* pPrevious = element->pPrevious;
+	listobj* pNext = element->pNext;
+
+	// Move towards the head past later deadlines
+	while (pPrevious != NULL && pPrevious->pTask->DeadLine > nDeadline)
+	{
+		pNext = pPrevious;
+		pPrevious = pPrevious->pPrevious;
+	}
+
+	// Move towards the tail past deadlines that are not later
+	while (pNext != NULL && pNext->pTask->DeadLine <= nDeadline)
+	{
+		pPrevious = pNext;
+		pNext = pNext->pNext;
+	}
+
+	if (pPrevious == element->pPrevious && pNext == element->pNext)
+	{ // Already in place
+		return true;
+	}
+
+	// Unlink the element
+	if (element->pPrevious != NULL)
+	{
+		element->pPrevious->pNext = element->pNext;
+	}
+	else
+	{
+		list->pHead = element->pNext;
+	}
+
+	if (element->pNext != NULL)
+	{
+		element->pNext->pPrevious = element->pPrevious;
+	}
+	else
+	{
+		list->pTail = element->pPrevious;
+	}
+
+	// Link it between its new neighbours
+	element->pPrevious = pPrevious;
+	element->pNext = pNext;
+
+	if (pPrevious != NULL)
+	{
+		pPrevious->pNext = element;
+	}
+	else
+	{
+		list->pHead = element;
+	}
+
+	if (pNext != NULL)
+	{
+		pNext->pPrevious = element;
+	}
+	else
+	{
+		list->pTail = element;
+	}
+
+	return true;
+}
+
+///
+/// @fn	bool OSList_levelInsert(OSList_t* list, listobj* element);
+///
+/// Inserts a listobject in ascending order according to the relative 
+/// deadline, the preemption level of the task.
+/// 
+/// @brief	Deadline monotonic ready insert.
+///
+/// @param [in,out]	list   	If non-null, the list.
+/// @param [in,out]	element	If non-null, the element.
+///
+/// @return	True if it succeeds, false if it fails.
+///
+bool OSList_levelInsert(OSList_t* list, listobj* element)
+{
+	// Check parameters
+	if (list == NULL || element == NULL)
+	{
+		return false;
+	}
+
+	if (list->size == 0)
+	{
+		addWhenZero(list, element);
+	}
+	else if (element->nRelDeadline < list->pHead->nRelDeadline)
+	{
+		addInFront(list, element);
+	}
+	else if (element->nRelDeadline >= list->pTail->nRelDeadline)
+	{
+		addInBack(list, element);
+	}
+	else
+	{
+		listobj* tmp = list->pHead;
+
+		// Traverse the list until the position for which to insert element is found
+		for (int i = 0;
+			i < (list->size - 1) && tmp->pNext->nRelDeadline <= element->nRelDeadline;
+			i++, tmp = tmp->pNext) {};
+
+		// Insert element after the listobj
+		// pointed to by tmp
+		insertAfter(tmp, element);
+	}
+
+	// Increment list size
+	element->pList = list;
+	list->size++;
+	return true;
+}
+
+///
+/// @fn	bool OSList_priorityInsert(OSList_t* list, listobj* element);
+///
+/// The bitmap is masked to the priorities that are the same or higher
+/// than the priority of the element, the lowest of them is found by a
+/// count of the leading zeros and the element is inserted after its 
+/// last task.
+/// 
+/// @brief	Fixed priority ready insert.
+///
+/// @param [in,out]	list   	If non-null, the list.
+/// @param [in,out]	element	If non-null, the element.
+///
+/// @return	True if it succeeds, false if it fails.
+///
+bool OSList_priorityInsert(OSList_t* list, listobj* element)
+{
+	// Check parameters
+	if (list == NULL || element == NULL || element->nPriority >= SCHED_PRIORITIES)
+	{
+		return false;
+	}
+
+	uint32_t nHigher = list->priorityBitmap & ((2UL << element->nPriority) - 1);
+
+	if (list->size == 0)
+	{
+		addWhenZero(list, element);
+	}
+	else if (nHigher == 0)
+	{ // Higher than all tasks in the list
+		addInFront(list, element);
+	}
+	else
+	{
+		listobj* tmp = list->priorityTail[highestBit(nHigher)];
+		if (tmp == list->pTail)
+		{
+			addInBack(list, element);
+		}
+		else
+		{
+			insertAfter(tmp, element);
+		}
+	}
+
+	list->priorityTail[element->nPriority] = element;
+	list->priorityBitmap |= 1UL << element->nPriority;
+
+	// Increment list size
+	element->pList = list;
+	list->size++;
+	return true;
+}
+
+///
+/// @fn	bool OSList_priorityRemove(OSList_t* list, listobj* element);
+///
+/// @brief	Removes a listobject inserted by OSList_priorityInsert.
+///
+/// @param [in,out]	list   	If non-null, the list.
+/// @param [in,out]	element	If non-null, the element.
+///
+/// @return	True if it succeeds, false if the element is not in the list.
+///
+bool OSList_priorityRemove(OSList_t* list, listobj* element)
+{
+	listobj* pPrevious = (element != NULL) ? element->pPrevious : NULL;
+
+	if (!OSList_remove(list, element))
+	{
+		return false;
+	}
+
+	if (list->priorityTail[element->nPriority] == element)
+	{ // The last task of its priority
+		if (pPrevious != NULL && pPrevious->nPriority == element->nPriority)
+		{
+			list->priorityTail[element->nPriority] = pPrevious;
+		}
+		else
+		{
+			list->priorityTail[element->nPriority] = NULL;
+			list->priorityBitmap &= ~(1UL << element->nPriority);
+		}
+	}
+
+	return true;
+}
+
+///
+/// @fn	bool OSList_frontInsert(OSList_t* list, listobj* element);
+///
+/// Inserts a listobject at the front of the list in constant time, 
+/// used for lists that are not sorted.
+/// 
+/// @brief	Operating system list front insert.
+///
+/// @param [in,out]	list   	If non-null, the list.
+/// @param [in,out]	element	If non-null, the element.
+///
+/// @return	True if it succeeds, false if it fails.
+///
+bool OSList_frontInsert(OSList_t* list, listobj* element)
+{
+	// Check parameters
+	if (list == NULL || element == NULL)
+	{
+		return false;
+	}
+
+	element->pPrevious = NULL;
+	element->pNext = NULL;
+
+	if (list->size == 0)
+	{
+		addWhenZero(list, element);
+	}
+	else
+	{
+		addInFront(list, element);
+	}
+
+	// Increment list size
+	element->pList = list;
 	list->size++;
 	return true;
 }
@@ -259,6 +631,7 @@ listobj* OSList_getFirst(OSList_t* list)
 	
 	tmp->pNext = NULL;
 	tmp->pPrevious = NULL;
+	tmp->pList = NULL;
 	list->size--;
 	return tmp;
 }
@@ -279,55 +652,51 @@ listobj* OSList_getFirst(OSList_t* list)
 bool OSList_remove(OSList_t* list, listobj* element)
 {
 	// Check argument
-	if (list == NULL || list->size == 0 || element == NULL)
-	{ // faulty arguments
+	if (!OSList_contains(list, element))
+	{ // faulty arguments or not in the list
 		return false;
 	}
 
-	if (list->pHead == element && list->size == 1)
+	if (element->pPrevious != NULL)
 	{
-		list->pHead = NULL;
-		list->pTail = NULL;
-	} 
-	else if (list->pHead == element && list->size > 1)
+		element->pPrevious->pNext = element->pNext;
+	}
+	else
 	{
-		list->pHead = list->pHead->pNext;
-		list->pHead->pPrevious = NULL;
-		element->pNext = NULL;
+		list->pHead = element->pNext;
 	}
-	else if (list->pTail == element && list->size > 1)
+
+	if (element->pNext != NULL)
 	{
-		list->pTail = list->pTail->pPrevious;
-		list->pTail->pNext = NULL;
-		element->pPrevious = NULL;
+		element->pNext->pPrevious = element->pPrevious;
 	}
 	else
 	{
-		listobj* tmp = list->pHead->pNext;
-		while (tmp != NULL)
-		{
-			if (tmp == element)
-			{
-				tmp->pPrevious->pNext = tmp->pNext;
-				tmp->pNext->pPrevious = tmp->pPrevious;
-				tmp->pNext = NULL;
-				tmp->pPrevious = NULL;
-				break;
-			}
-			tmp = tmp->pNext;
-		}
-
-		if (tmp == NULL)
-		{
-			return false;
-		}
+		list->pTail = element->pPrevious;
 	}
 
-
+	element->pNext = NULL;
+	element->pPrevious = NULL;
+	element->pList = NULL;
 	list->size--;
 	return true;
 }
 
+///
+/// @fn	bool OSList_contains(OSList_t* list, listobj* element);
+///
+/// @brief	Checks in constant time if an element is in a list.
+///
+/// @param [in]	list   	The list.
+/// @param [in]	element	If non-null, the element.
+///
+/// @return	True if the element is in the list.
+///
+bool OSList_contains(OSList_t* list, listobj* element)
+{
+	return list != NULL && element != NULL && element->pList == list;
+}
+
 ///
 /// @fn	listobj* OSList_peek(OSList_t* list);
 ///
@@ -1,10 +1,13 @@
 
 .686P							;Target processor.  Use all available instructions (x86)
+.XMM							;Enable FXSAVE/FXRSTOR
 .MODEL FLAT, C					;Use the flat memory model. Use C calling conventions
 
 ;Externally defined variables
 EXTERN Running:DWORD			;A pointer to the currently running task's Tcb_t
 EXTERN isrOnState:DWORD			;A pointer to the interrupt state
+EXTERN isrNesting:DWORD			;A pointer to the critical section nesting depth
+EXTERN kernelPreempt:PROC		;Switches from a preempted task
 
 .DATA							;Create a near data segment.
 	EAXTMP	DWORD	0			;Temporary storage for EAX register
@@ -86,8 +89,31 @@ LoadContext PROC
 	PUSH [PCTMP]				;Push PC onto stack
 
 	;Set interrupt state
+	MOV isrNesting, 0			;Leave all critical sections
 	MOV isrOnState, 1
 
 	RET							;Will pop PC from stack and branch
 LoadContext ENDP
+
+
+;*******************************************************************************************
+; Entered with the interrupted EIP pushed on the stack when the timer thread
+; preempts the running task. Saves the registers, the flags and the FPU/SSE 
+; state that a function call may clobber and calls kernelPreempt.
+;*******************************************************************************************
+PUBLIC PreemptTrampoline
+PreemptTrampoline PROC
+	PUSHFD
+	PUSHAD
+	MOV EBP, ESP				;EBP is restored by LoadContext
+	SUB ESP, 512				;FXSAVE needs 512 bytes aligned to 16
+	AND ESP, 0FFFFFFF0h
+	FXSAVE [ESP]
+	CALL kernelPreempt
+	FXRSTOR [ESP]
+	MOV ESP, EBP
+	POPAD
+	POPFD
+	RET							;Will pop the interrupted EIP and branch
+PreemptTrampoline ENDP
 END
\ No newline at end of file
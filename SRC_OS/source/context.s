@@ -1,4 +1,10 @@
 	IMPORT Running
+	IMPORT isrNesting
+	IMPORT kernelTick
+	IMPORT kernelPreempt
+	IMPORT preemptPC
+	EXPORT SysTick_Handler
+	EXPORT PreemptTrampoline
 	EXPORT SetXPSR
 	EXPORT LoadContext
 	EXPORT SaveContext
@@ -37,6 +43,18 @@ SaveContext PROC
          
     ADD 	R1,SP,#8                    ; Fetch Stackpointer
     STR 	R1,[R0,#52]                 ; and save to TCB->SP  	  
+	IF :DEF:_CORTEX_M_FPU_
+    MRS 	R1, CONTROL                 ; CONTROL.FPCA is set if this task
+    ANDS	R1, R1, #4                  ; has touched the FPU
+    BEQ 	noFPUSave
+    VMRS	R1, FPSCR                   ; Save FPSCR to TCB->FPSCR
+    STR 	R1, [R0, #132]
+    ADD 	R1, R0, #68                 ; R1->TCB->FPContext
+    VSTMIA	R1, {S16-S31}               ; Save callee-saved FPU registers
+    MOV 	R1, #1
+noFPUSave
+    STR 	R1, [R0, #64]               ; TCB->FPUsed = FPCA
+	ENDIF
     LDMIA 	SP!,{R0,R1}                  	  
     BX 		LR                        	; Return to C-program
 	ENDP
@@ -45,8 +63,29 @@ SaveContext PROC
 ;  void LoadContext(void)
 ;***************************************************************************    
 LoadContext PROC
+    CPSID	I                           ; mask all interrupts while Running is restored
+    MOV 	R0, #0
+    MSR 	BASEPRI, R0                 ; leave all kernel critical sections
+    LDR 	R1, =isrNesting
+    STR 	R0, [R1]
     LDR 	R0, =Running
     LDR 	R0, [R0]
+	IF :DEF:_CORTEX_M_FPU_
+    MRS 	R2, CONTROL
+    LDR 	R1, [R0, #64]               ; Running->FPUsed
+    CBZ 	R1, noFPULoad               ; Task has never touched the FPU
+    ADD 	R1, R0, #68                 ; R1->Running->FPContext
+    VLDMIA	R1, {S16-S31}               ; Restore callee-saved FPU registers
+    LDR 	R1, [R0, #132]              ; Restore FPSCR
+    VMSR	FPSCR, R1
+    ORR 	R2, R2, #4                  ; CONTROL.FPCA = 1
+    B   	setFPCA
+noFPULoad
+    BIC 	R2, R2, #4                  ; CONTROL.FPCA = 0
+setFPCA
+    MSR 	CONTROL, R2
+    ISB
+	ENDIF
 		
     LDR 	R1, [R0, #52]               ; Catch Running-> SP
     SUB 	SP, SP, #8	                ; Find a unused stack area
@@ -77,10 +116,71 @@ skipSPSR
 
 	POP 	{R0, R1}
 	LDR 	SP, [R13, #4] 
+	CPSIE	I                           ; enable interrupts
 	BX 		LR
 trap
       B .
    ENDP
+
+;****************************************************************************
+;  void SysTick_Handler(void)
+;  Passes the exception frame of the interrupted task to kernelTick()
+;***************************************************************************
+SysTick_Handler PROC
+    TST 	LR, #4                      ; Find the stack the frame was pushed on
+    ITE 	EQ
+    MRSEQ	R0, MSP
+    MRSNE	R0, PSP
+    B   	kernelTick
+	ENDP
+
+;****************************************************************************
+;  void PreemptTrampoline(void)
+;  Entered instead of the instruction at preemptPC when the tick preempts
+;  a task. The registers that a function call may clobber are saved on the
+;  stack of the task, which is switched out by kernelPreempt().
+;***************************************************************************
+PreemptTrampoline PROC
+    SUB 	SP, SP, #4                  ; Room for the return address
+    PUSH	{R0-R4, R12, LR}
+    MRS 	R0, APSR                    ; Save the flags
+    PUSH	{R0}
+    LDR 	R0, =preemptPC              ; Return to the interrupted instruction
+    LDR 	R0, [R0]
+    ORR 	R0, R0, #1                  ; Thumb state
+    STR 	R0, [SP, #32]
+	IF :DEF:_CORTEX_M_FPU_
+    MRS 	R0, CONTROL                 ; CONTROL.FPCA is set if this task
+    ANDS	R0, R0, #4                  ; has touched the FPU
+    BEQ 	noFPUPush
+    VMRS	R1, FPSCR                   ; Save FPSCR and the caller-saved
+    PUSH	{R1}                        ; FPU registers
+    VPUSH	{S0-S15}
+noFPUPush
+    PUSH	{R0}                        ; Remember if they were saved
+	ENDIF
+    MOV 	R4, SP                      ; Align the stack for the call,
+    BIC 	R0, R4, #7                  ; R4 is restored by LoadContext
+    MOV 	SP, R0
+    BL  	kernelPreempt
+    MOV 	SP, R4
+	IF :DEF:_CORTEX_M_FPU_
+    POP 	{R0}
+    CBZ 	R0, noFPUPop
+    VPOP	{S0-S15}
+    POP 	{R1}
+    VMSR	FPSCR, R1
+noFPUPop
+	ENDIF
+    POP 	{R0}
+	IF {TARGET_FEATURE_DSPMUL}
+    MSR 	APSR_nzcvqg, R0             ; Restore the flags and the SIMD GE bits
+	ELSE
+    MSR 	APSR_nzcvq, R0              ; Restore the flags
+	ENDIF
+    POP 	{R0-R4, R12, LR}
+    POP 	{PC}                        ; Resume the task
+	ENDP
 	   
    ALIGN 4
    END	
\ No newline at end of file
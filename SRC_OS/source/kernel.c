@@ -2,7 +2,9 @@
 /// This file defines the application programming interface to the kernel.
 /// Please define what architecture you intend to run the kernel on.
 /// for texas dsp simply define "texas dsp", for ARM cortex-m processors 
-/// (no FPU support) please define "_CORTEX_M_", for x86 architecture
+/// (no FPU support) please define "_CORTEX_M_", for ARM cortex-m processors
+/// with a single precision FPU (Cortex-M4F) please define both "_CORTEX_M_" 
+/// and "_CORTEX_M_FPU_", for x86 architecture
 /// Please define "X86". If you intend to run this kernel on x86 architecture
 /// please instatiate a new thread that periodically calls the timerISR(); 
 /// routine. 
@@ -23,6 +25,7 @@
 #include "kernel.h"
 #include "OSList.h"
 #include "OS_malloc.h"
+#include <string.h>
 
 #ifdef _X86_
 #include <Windows.h>
@@ -43,6 +46,13 @@ static OSList_t* readyList = NULL;
 static OSList_t* waitingList = NULL;
 static OSList_t* timerList = NULL;
 
+/// @brief	Terminated tasks, recycled by create_task().
+static OSList_t* freeList = NULL;
+
+/// @brief	The SRP system ceiling, the shortest relative deadline among
+/// 		the ceilings of all locked mutexes.
+static uint systemCeiling = UINT32_MAX;
+
 #define SEND_WAIT 0xF1
 #define SEND_NO_WAIT 0xF2
 
@@ -55,8 +65,87 @@ static uint opMode = UNINITIALIZED;
 TCB* Running;
 listobj* runningListobj;
 
+/// @brief	True when interrupts are enabled i.e. no critical section is active.
 bool isrOnState = false;
 
+/// @brief	Critical section nesting depth, reset by LoadContext().
+uint isrNesting = 0;
+
+///
+/// @struct	idleHookEntry
+///
+/// @brief	A registered idle hook.
+///
+typedef struct {
+	bool	(*pHook)(void);		///<The hook function.
+	uint	nQuantum;			///<The maximum number of ticks the hook may run per call.
+	volatile bool bArmed;		///<False after the hook reported that it has no work.
+} idleHookEntry;
+
+/// @brief	Registered idle hooks.
+static idleHookEntry idleHooks[MAX_IDLE_HOOKS];
+static uint nIdleHooks = 0;
+
+/// @brief	The tick at which the executing idle hook was started and its quantum.
+static uint idleHookStart;
+static uint idleHookQuantum;
+
+#ifdef _X86_
+/// @brief	Signaled by the timer thread when the idle task should wake up.
+static HANDLE idleEvent = NULL;
+#endif
+
+/// @brief	The idle task.
+static listobj* idleListobj = NULL;
+
+/// @brief	True from the tick redirecting the running task to
+/// 		PreemptTrampoline until the task has entered kernelPreempt().
+static volatile bool preemptPending = false;
+
+/// @brief	True from the tick that moved the running task behind another
+/// 		task until the next context switch. The tick can not always 
+/// 		redirect the task, a later tick preempts it then.
+static volatile bool needPreempt = false;
+
+#ifdef _X86_
+/// @brief	The thread that executes the tasks, suspended by the timer thread.
+static HANDLE mainThread = NULL;
+#elif _CORTEX_M_
+/// @brief	The instruction at which the redirected task was interrupted.
+uint preemptPC;
+#endif
+
+/// @brief	The dispatch table of the time-triggered mode, NULL in EDF mode.
+static ttslot* ttTable = NULL;
+static uint ttSlots;
+static uint ttHyperperiod;
+
+/// @brief	The next slot of the table and the tick within the hyperperiod.
+static uint ttNext;
+static uint ttPhase;
+
+/// @brief	The number of due slots that the dispatcher task has not run
+/// 		yet and the first of them, slots are run in table order.
+static volatile uint ttPending = 0;
+static uint ttRun;
+
+/// @brief	The dispatcher task of the time-triggered mode.
+static listobj* ttListobj = NULL;
+
+/// @brief	The length of a time slice in ticks, 0 disables time slicing.
+static uint sliceLength = TIME_SLICE_TICKS;
+
+/// @brief	The task using the current time slice and the ticks it has used.
+static listobj* sliceOwner = NULL;
+static uint sliceTicks = 0;
+
+/// @brief	The tasks admitted with a declared WCET, linked by pAdmitted, their
+/// 		number and their total utilization and density scaled by ADMISSION_SCALE.
+static listobj* admittedTasks = NULL;
+static uint admittedCount = 0;
+static unsigned long long admittedUtil = 0;
+static unsigned long long admittedDensity = 0;
+
 //////////////////////////////////////////////////////////////////////////////
 //							Macros
 //////////////////////////////////////////////////////////////////////////////
@@ -73,10 +162,59 @@ bool isrOnState = false;
 /// @param	fnBody  	The body.
 /// @param	deadline	The deadline.
 ///
+/// A recycled task is initialized without clearing its stack or
+/// registers, only the state that the kernel depends on is reset.
+/// 
 #define initTask(listob, fnBody, deadline) \
 				listob->pTask->PC = fnBody;	\
 				listob->pTask->SP = &(listob->pTask->StackSeg[STACK_SIZE - 1]); \
 				listob->pTask->DeadLine = deadline; \
+				listob->pMessage = NULL; \
+				listob->pLocked = NULL; \
+				listob->nNotifyMask = 0; \
+				listob->pCall = NULL; \
+				listob->nPeriod = 0; \
+				listob->nCbsBudget = 0; \
+				listob->pBody = fnBody; \
+				listob->nOverrunPolicy = OVERRUN_NONE; \
+				listob->nWcet = 0; \
+				listob->nThreshold = 0; \
+				listob->nPreemptClass = 0; \
+				listob->nPriority = SCHED_PRIORITIES - 2; \
+				listob->pTask->Notification = 0; \
+				initStatus(listob); \
+				initFPU(listob); \
+
+///
+/// @def	initStatus(listob);
+///
+/// @brief	Clears the saved status flags so that LoadContext treats the 
+/// 		task as loaded for the first time.
+///
+/// @param	listob	The listob.
+///
+#ifdef _CORTEX_M_
+#define initStatus(listob) \
+				listob->pTask->SPSR = 0 \
+
+#else
+#define initStatus(listob)
+#endif
+
+///
+/// @def	initFPU(listob);
+///
+/// @brief	Marks the FPU context of a task as unused.
+///
+/// @param	listob	The listob.
+///
+#ifdef _CORTEX_M_FPU_
+#define initFPU(listob) \
+				listob->pTask->FPUsed = 0 \
+
+#else
+#define initFPU(listob)
+#endif
 
 ///
 /// @def	setRunningTask(listob);
@@ -92,833 +230,4341 @@ bool isrOnState = false;
 				Running = listob->pTask; \
 				runningListobj = listob; \
 
+/// @brief	Fixed point scale of utilizations, a utilization of 1 is ADMISSION_SCALE.
+#define ADMISSION_SCALE 0x10000ULL
+
+#ifdef _CORTEX_M_
+/// @brief	xPSR bits of an interrupted IT block or multiple load/store and
+/// 		of an interrupted exception handler.
+#define XPSR_ICI_IT_Msk	0x0600FC00UL
+#define XPSR_IPSR_Msk	0x000001FFUL
+#endif
+
+///
+/// @def	memoryBarrier();
+///
+/// @brief	Orders memory accesses for the compiler and the cpu.
+///
+#ifdef _CORTEX_M_
+#define memoryBarrier() __DMB()
+#elif _X86_
+#define memoryBarrier() MemoryBarrier()
+#else
+#define memoryBarrier()
+#endif
+
 //////////////////////////////////////////////////////////////////////////////
 ///							Private functions
 //////////////////////////////////////////////////////////////////////////////
 
+static void msgDeadlineChanged(listobj* pTask);
+
 ///
-/// @fn	static void schedulingUpdate(void)
+/// @fn	static void cbsWake(listobj* pTask)
 ///
-/// @brief	Scheduling update.
+/// Applies the wake up rule of the Constant Bandwidth Server to a task 
+/// that becomes ready. If the remaining budget can not be consumed before
+/// the current deadline without exceeding the bandwidth of the server,
+/// the budget is replenished and the deadline is set one period ahead.
+/// Must be called before the task is inserted in the readyList.
+/// 
+/// @brief	Wakes a CBS task.
 ///
-/// @author	Albin Hjalmas.
-/// @date	1/30/2017
+/// @param [in,out]	pTask	The task.
 ///
-static void schedulingUpdate(void)
+static void cbsWake(listobj* pTask)
 {
-	// Check timerList for tasks ready for execution.
-	listobj* tmp = OSList_peek(timerList);
-	while(tmp != NULL)
-	{ // Traverse the list
-		if (tmp->nTCnt <= osTicks)
-		{ // Task is ready for execution
-			OSList_readyInsert(readyList, OSList_getFirst(timerList));
-			tmp = OSList_peek(timerList);
-		}
-		else // If the first element in timerList is not
-			 // ready for execution then no elements in timerList
-			 // are ready for execution because the list is sorted.
-		{
-			break;
-		}
+	if (pTask->nCbsBudget == 0)
+	{ // Not a server
+		return;
 	}
 
-	// Check waitinglist for expired deadlines
-	// If a task with expired deadline is found
-	// Then this task will be transferred to the readyList.
-	// And the deadline will be updated.
-	tmp = OSList_peek(waitingList);
-	while (tmp != NULL)
+	if (pTask->pTask->DeadLine <= osTicks ||
+		(unsigned long long)pTask->nCbsRemaining * pTask->nCbsPeriod >=
+		(unsigned long long)(pTask->pTask->DeadLine - osTicks) * pTask->nCbsBudget)
 	{
-		if (tmp->pTask->DeadLine <= osTicks)
-		{  // The deadLine is reached
-			OSList_readyInsert(readyList, OSList_getFirst(waitingList));
-			tmp = OSList_peek(waitingList);
-		}
-		else // If the first element in waitingList has not
-		{	 // reached its deadline then none of the elements has.
-			break;
-		}
-	}
+		pTask->nCbsRemaining = pTask->nCbsBudget;
+		pTask->pTask->DeadLine = osTicks + pTask->nCbsPeriod;
 
-	// Set the currently running task
-	setRunningTask(OSList_peek(readyList));
+		// A task woken by its timeout is still queued on its message
+		msgDeadlineChanged(pTask);
+	}
 }
 
 ///
-/// @fn	static void idleTask(void)
+/// @fn	static bool cbsCharge(void)
 ///
-/// @brief	Idle task.
+/// Charges one tick to the running task if it is a CBS task. When the
+/// budget is exhausted it is replenished and the deadline is postponed
+/// by one period, the task is requeued according to its new deadline.
+/// 
+/// @brief	Charges the running CBS task.
 ///
-/// @author	Albin Hjalmas.
-/// @date	1/30/2017
+/// @return	True if the deadline of the running task was postponed.
 ///
-static void idleTask(void)
+static bool cbsCharge(void)
 {
-	while (true)
+	if (runningListobj->nCbsBudget == 0 || --runningListobj->nCbsRemaining > 0)
 	{
-		if (Running->PC != idleTask)
-		{ // This means that the timer interrupt has 
-		  // induced a context switch
-			isr_off();		// disable interrupts
-			LoadContext();  // load context and reenable interrupts
-		}
+		return false;
 	}
-}
 
+	runningListobj->nCbsRemaining = runningListobj->nCbsBudget;
+	Running->DeadLine += runningListobj->nCbsPeriod;
+
+	if (OSList_readyRemove(readyList, runningListobj))
+	{
+		OSList_readyInsert(readyList, runningListobj);
+	}
+	msgDeadlineChanged(runningListobj);
+
+	return true;
+}
 
-#ifdef _X86_
 ///
-/// @fn	void timerInterrupt(void)
+/// @fn	static bool overrunPending(listobj* pTask)
 ///
-/// @brief	Timer interrupt thread.
+/// A task that is blocked in the kernel when its deadline is reached 
+/// returns DEADLINE_REACHED and handles the overrun itself, a task that
+/// holds a mutex or serves a call is left alone to not break the 
+/// ceilings or the caller. The kernel functions that take several steps,
+/// such as allocating a task and inserting it in a list, run in one 
+/// critical section so the tick never restarts a task between steps.
+/// 
+/// @brief	Checks if the overrun policy of a task should be applied.
 ///
-/// @author	Albin Hjalmas
-/// @date	1/30/2017
+/// @param [in]	pTask	The task.
 ///
-void timerInterrupt(void)
-{
-	while (true)
-	{
-		// Sleep for 20ms
-		Sleep(20);
-
-		if (isrOnState)
-		{ // Only execute this if interrupts is turned on.
-			osTicks++;
-			schedulingUpdate();
-		}
-	}
-}
-#elif _CORTEX_M_
-void SysTick_Handler(void)
+/// @return	True if the policy should be applied.
+///
+static bool overrunPending(listobj* pTask)
 {
-	osTicks++;
-	schedulingUpdate();
+	return pTask->nOverrunPolicy != OVERRUN_NONE && pTask->pTask->DeadLine <= osTicks
+		&& pTask->pMessage == NULL && pTask->nNotifyMask == 0 
+		&& pTask->nLocks == 0 && pTask->pCall == NULL;
 }
-#endif
-
-//////////////////////////////////////////////////////////////////////////////
-///				Task administration Function definitions.
-//////////////////////////////////////////////////////////////////////////////
 
 ///
-/// @fn	int init_kernel(void);
+/// @fn	static void restartTask(listobj* pTask)
 ///
-/// @brief	Init kernel.
+/// The saved context of the task is discarded, the next time it is
+/// loaded it starts from the beginning of its body on an empty stack.
+/// 
+/// @brief	Restarts the body of a task.
 ///
-/// @date	1/30/2017
+/// @param [in,out]	pTask	The task.
 ///
-/// @return	FAIL if failed or SUCCESS if successful.
+static void restartTask(listobj* pTask)
+{
+	pTask->pTask->PC = pTask->pBody;
+	pTask->pTask->SP = &(pTask->pTask->StackSeg[STACK_SIZE - 1]);
+	initStatus(pTask);
+	initFPU(pTask);
+}
+
 ///
-exception init_kernel(void)
+/// @fn	static void applyOverrunPolicies(void)
+///
+/// Every policy gives the task a deadline in the future or moves it to 
+/// the timerList. Under EDF the tasks that overran are found before the
+/// first task whose deadline has not been reached, the other policies
+/// do not order the readyList by deadline and the whole list is searched.
+/// 
+/// @brief	Applies the overrun policies of tasks that overran.
+///
+static void applyOverrunPolicies(void)
 {
-	osTicks = 0;
+	listobj* tmp = OSList_peek(readyList);
+	while (tmp != NULL)
+	{
+		if (SCHED_POLICY == SCHED_EDF && tmp->pTask->DeadLine > osTicks)
+		{ // No later task has overrun
+			break;
+		}
+		else if (!overrunPending(tmp))
+		{ // A task that is exempt does not hide the tasks behind it
+			tmp = tmp->pNext;
+			continue;
+		}
 
-	// Create readyList
-	if ((readyList = OSList_create()) == NULL)
-	{ // Unable to allocate memory for list.
-		return FAIL;
-	}
+		OSList_readyRemove(readyList, tmp);
 
-	// Create waitingList
-	if ((waitingList = OSList_create()) == NULL)
-	{ // Unable to allocate memory for list.
-		free(readyList);
-		return FAIL;
-	}
+		switch (tmp->nOverrunPolicy)
+		{
+		case OVERRUN_SKIP:
+			// Drop the missed jobs and wait for the next release
+			do
+			{
+				tmp->nRelease += tmp->nPeriod;
+			} while (tmp->nRelease <= osTicks);
+			tmp->pTask->DeadLine = tmp->nRelease + tmp->nRelDeadline;
+			restartTask(tmp);
+			OSList_timerInsertAt(timerList, tmp, tmp->nRelease);
+			break;
 
-	// Create timerList
-	if ((timerList = OSList_create()) == NULL)
-	{ // Unable to allocate memory for list.
-		free(readyList);
-		free(waitingList);
-		return FAIL;
-	}
+		case OVERRUN_ABORT:
+			tmp->pTask->DeadLine = osTicks + tmp->nRelDeadline;
+			restartTask(tmp);
+			OSList_readyInsert(readyList, tmp);
+			break;
 
-	// Create the idle task
-	listobj* idleTaskOb = OSList_createListobj();
-	if (idleTaskOb == NULL)
-	{ // Something went wrong
-		free(readyList);
-		free(waitingList);
-		free(timerList);
-		return FAIL;
-	}
+		case OVERRUN_HANDLER:
+			tmp->pTask->DeadLine = tmp->pOverrunHandler(tmp);
+			if (tmp->pTask->DeadLine > osTicks)
+			{
+				OSList_readyInsert(readyList, tmp);
+				break;
+			}
+			// A deadline that has passed demotes the task
 
-	// Initialize the idle task
-	initTask(idleTaskOb, idleTask, UINT32_MAX);
+		default: // OVERRUN_DEMOTE, only the idle task runs later under EDF
+			tmp->pTask->DeadLine = UINT32_MAX - 1;
+			OSList_readyInsert(readyList, tmp);
+			break;
+		}
 
-	if (!OSList_readyInsert(readyList, idleTaskOb))
-	{ // Something went wrong!
-		free(readyList);
-		free(waitingList);
-		free(timerList);
-		free(idleTaskOb);
-		return FAIL;
+		// Start over since the readyList has been reordered
+		tmp = OSList_peek(readyList);
 	}
+}
 
-	// Set the currently running task
-	setRunningTask(idleTaskOb);
-
-	// Set kernel operating mode.
-	opMode = INIT;
-
-	return SUCCESS;
+///
+/// @fn	static uint admittedPeriod(listobj* pTask)
+///
+/// @brief	Gets the period of an admitted task, the server period of a CBS task.
+///
+/// @param [in]	pTask	The task.
+///
+/// @return	The period.
+///
+static uint admittedPeriod(listobj* pTask)
+{
+	return (pTask->nPeriod != 0) ? pTask->nPeriod : pTask->nCbsPeriod;
 }
 
 ///
-/// @fn	exception create_task(void(*body)(), uint d)
+/// @fn	static unsigned long long scaledShare(uint nWcet, uint nInterval)
 ///
-/// @brief	Creates a task, Requires that init_kernel() have been executed.
+/// @brief	Computes nWcet / nInterval scaled by ADMISSION_SCALE, rounded up.
 ///
-/// @author	Albin Hjalmas.
-/// @date	1/30/2017
+/// @param	nWcet	 	The execution time.
+/// @param	nInterval	The period or the relative deadline.
 ///
-/// @param [in,out]	body	If non-null, the body.
-/// @param 		   	d   	The deadline.
+/// @return	The scaled share.
 ///
-/// @return	FAIL or SUCCESS.
+static unsigned long long scaledShare(uint nWcet, uint nInterval)
+{
+	return ((unsigned long long)nWcet * ADMISSION_SCALE + nInterval - 1) / nInterval;
+}
+
 ///
-exception create_task(void(*body)(), uint d)
+/// @fn	static bool demandTest(listobj* pTasks, unsigned long long nUtil)
+///
+/// Checks that the processor demand of the tasks never exceeds the 
+/// length of an interval. The demand only changes at absolute deadlines
+/// and only intervals shorter than sum((T - D) * C / T) / (1 - U), or the
+/// longest relative deadline, have to be checked. The test runs with 
+/// interrupts disabled, hence longer intervals than ADMISSION_MAX_INTERVAL
+/// are rejected instead of checked.
+/// 
+/// @brief	Processor demand test of a task set with a utilization below 1.
+///
+/// @param [in]	pTasks	The tasks, linked by pAdmitted.
+/// @param 		nUtil 	The scaled utilization of the tasks.
+///
+/// @return	True if the tasks are schedulable by EDF.
+///
+static bool demandTest(listobj* pTasks, unsigned long long nUtil)
 {
-	// must pass a valid function
-	// body. and delay time cannot be 0.
-	// Also check if the OSList's has been properly
-	// initialized.
-	if (body == NULL || d == 0 || readyList == NULL 
-		|| waitingList == NULL || timerList == NULL
-		|| opMode == UNINITIALIZED || d < 0)
+	unsigned long long nSlack = 0;
+	unsigned long long nLength = 0;
+	for (listobj* tmp = pTasks; tmp != NULL; tmp = tmp->pAdmitted)
 	{
-		return FAIL;
+		uint nPeriod = admittedPeriod(tmp);
+		if (nPeriod > tmp->nRelDeadline)
+		{
+			nSlack += scaledShare(tmp->nWcet, nPeriod) * (nPeriod - tmp->nRelDeadline);
+		}
+		if (tmp->nRelDeadline > nLength)
+		{
+			nLength = tmp->nRelDeadline;
+		}
 	}
 
-	// Create the task
-	listobj* task = OSList_createListobj();
-	if (task == NULL) // Unable to allocate memory.
+	unsigned long long nBound = (nSlack + ADMISSION_SCALE - nUtil - 1) / (ADMISSION_SCALE - nUtil);
+	if (nBound > nLength)
 	{
-		return FAIL;
+		nLength = nBound;
 	}
 
-	// Initialize task
-	initTask(task, body, d);
-
-	if (opMode == INIT)
-	{ // Just add task to ready list.
-		if (!OSList_readyInsert(readyList, task)) 
-		{ // Something went wrong!
-			free(task);
-			return FAIL;
-		}
+	if (nLength > ADMISSION_MAX_INTERVAL)
+	{ // Too long to be checked, reject
+		return false;
 	}
-	else // opMode == RUNNING
-	{
-		isr_off();								// disable interrupts
-		volatile bool firstExecution = true;	// Create variable on stack
-		SaveContext();							// Save current context
 
-		// Load context will start running from here
-		// use firstExecution to make shure that execution
-		// wont get stuck in an endless loop.
-		if (firstExecution)
+	// Check the demand at every absolute deadline within the interval
+	for (listobj* pTask = pTasks; pTask != NULL; pTask = pTask->pAdmitted)
+	{
+		for (unsigned long long t = pTask->nRelDeadline; t <= nLength; t += admittedPeriod(pTask))
 		{
-			firstExecution = !firstExecution;
+			unsigned long long nDemand = 0;
+			for (listobj* tmp = pTasks; tmp != NULL; tmp = tmp->pAdmitted)
+			{
+				if (t >= tmp->nRelDeadline)
+				{
+					nDemand += ((t - tmp->nRelDeadline) / admittedPeriod(tmp) + 1) * tmp->nWcet;
+				}
+			}
 
-			// Insert task in ready-list
-			if (!OSList_readyInsert(readyList, task)) 
-			{ // Something went wrong!
-				free(task);
-				return FAIL;
+			if (nDemand > t)
+			{
+				return false;
 			}
-			
-			// Perform scheduling update
-			schedulingUpdate();
-			
-			// Load context and reenable interrupts
-			LoadContext();
 		}
 	}
 
-	// The creation of a task was successful!
-	return SUCCESS;
+	return true;
 }
 
 ///
-/// @fn	void terminate(void)
+/// @fn	static bool admit(listobj* pTask)
 ///
+/// The utilization and density of the admitted tasks are kept up to date
+/// so that most tasks are admitted or rejected in constant time, only
+/// when the density exceeds 1 with a utilization below 1 the processor
+/// demand of the task set is checked. Every share is rounded up by less
+/// than one unit, a sum that exceeds ADMISSION_SCALE by less than the 
+/// number of tasks counts as a full cpu so that exactly full task sets
+/// are admitted. Must be called with interrupts disabled.
+/// 
+/// @brief	Adds a task to the admitted tasks if they stay schedulable.
+///
+/// @param [in,out]	pTask	The task, with its WCET, period and deadline set.
+///
+/// @return	True if the task was admitted.
+///
+static bool admit(listobj* pTask)
+{
+	uint nPeriod = admittedPeriod(pTask);
+	uint nInterval = (pTask->nRelDeadline < nPeriod) ? pTask->nRelDeadline : nPeriod;
+	unsigned long long nUtil = admittedUtil + scaledShare(pTask->nWcet, nPeriod);
+	unsigned long long nDensity = admittedDensity + scaledShare(pTask->nWcet, nInterval);
+	unsigned long long nFull = ADMISSION_SCALE + admittedCount;	// The rounding margin
+
+	if (nUtil > nFull)
+	{ // Overload
+		return false;
+	}
+
+	pTask->pAdmitted = admittedTasks;
+	if (nDensity > nFull && 
+		(nUtil >= ADMISSION_SCALE || !demandTest(pTask, nUtil)))
+	{
+		return false;
+	}
+
+	admittedTasks = pTask;
+	admittedCount++;
+	admittedUtil = nUtil;
+	admittedDensity = nDensity;
+	return true;
+}
+
+///
+/// @fn	static void dismiss(listobj* pTask)
+///
+/// @brief	Removes a task from the admitted tasks, if it was admitted.
+///
+/// @param [in,out]	pTask	The task.
+///
+static void dismiss(listobj* pTask)
+{
+	if (pTask->nWcet == 0)
+	{
+		return;
+	}
+
+	uint nPeriod = admittedPeriod(pTask);
+	uint nInterval = (pTask->nRelDeadline < nPeriod) ? pTask->nRelDeadline : nPeriod;
+	admittedUtil -= scaledShare(pTask->nWcet, nPeriod);
+	admittedDensity -= scaledShare(pTask->nWcet, nInterval);
+
+	listobj** ppTask = &admittedTasks;
+	while (*ppTask != pTask)
+	{
+		ppTask = &(*ppTask)->pAdmitted;
+	}
+	*ppTask = pTask->pAdmitted;
+	admittedCount--;
+	pTask->nWcet = 0;
+}
+
+///
+/// @fn	static void releaseTasks(void)
+///
+/// Moves tasks whose delay has expired (timerList) or whose deadline 
+/// has been reached (waitingList) to the readyList.
+/// 
+/// @brief	Releases tasks to the readyList.
+///
+/// @author	Albin Hjalmas.
+/// @date	1/30/2017
+///
+static void releaseTasks(void)
+{
+	// Check timerList for tasks ready for execution.
+	listobj* tmp = OSList_peek(timerList);
+	while(tmp != NULL)
+	{ // Traverse the list
+		if (tmp->nTCnt <= osTicks)
+		{ // Task is ready for execution
+			tmp = OSList_getFirst(timerList);
+			cbsWake(tmp);
+			OSList_readyInsert(readyList, tmp);
+			tmp = OSList_peek(timerList);
+		}
+		else // If the first element in timerList is not
+			 // ready for execution then no elements in timerList
+			 // are ready for execution because the list is sorted.
+		{
+			break;
+		}
+	}
+
+	// Check waitinglist for expired deadlines
+	// If a task with expired deadline is found
+	// Then this task will be transferred to the readyList.
+	// And the deadline will be updated.
+	tmp = OSList_peek(waitingList);
+	while (tmp != NULL)
+	{
+		if (tmp->pTask->DeadLine <= osTicks)
+		{  // The deadLine is reached
+			OSList_readyInsert(readyList, OSList_getFirst(waitingList));
+			tmp = OSList_peek(waitingList);
+		}
+		else // If the first element in waitingList has not
+		{	 // reached its deadline then none of the elements has.
+			break;
+		}
+	}
+}
+
+///
+/// @fn	static void* kernelCalloc(size_t nNum, size_t nSize)
+///
+/// Allocates with interrupts disabled since the allocator is not 
+/// reentrant and the tick may preempt the caller (CBS, overrun policies
+/// and time slicing) in favour of a task that allocates as well.
+/// 
+/// @brief	Allocates zeroed memory without being preempted.
+///
+/// @param	nNum 	Number of elements.
+/// @param	nSize	The size of an element.
+///
+/// @return	Null if it fails, else the memory.
+///
+static void* kernelCalloc(size_t nNum, size_t nSize)
+{
+	isr_off();
+	void* res = calloc(nNum, nSize);
+	isr_on();
+	return res;
+}
+
+///
+/// @fn	static void kernelFree(void* pMem)
+///
+/// @brief	Frees memory without being preempted, see kernelCalloc().
+///
+/// @param [in]	pMem	The memory.
+///
+static void kernelFree(void* pMem)
+{
+	isr_off();
+	free(pMem);
+	isr_on();
+}
+
+///
+/// @fn	static listobj* kernelCreateListobj(void)
+///
+/// @brief	Allocates a listobj without being preempted, see kernelCalloc().
+///
+/// @return	Null if it fails, else the listobj.
+///
+static listobj* kernelCreateListobj(void)
+{
+	isr_off();
+	listobj* res = OSList_createListobj();
+	isr_on();
+	return res;
+}
+
+///
+/// @fn	static bool msgQueueCreate(msg** ppHead, msg** ppTail)
+///
+/// Allocates the head and tail sentinels of a queue of messages of 
+/// blocked tasks in one block and links them to an empty queue.
+/// 
+/// @brief	Creates an empty message queue.
+///
+/// @param [out]	ppHead	The head sentinel.
+/// @param [out]	ppTail	The tail sentinel.
+///
+/// @return	False if memory allocation failed.
+///
+static bool msgQueueCreate(msg** ppHead, msg** ppTail)
+{
+	msg* pSentinels = (msg*)kernelCalloc(2, sizeof(msg));
+	if (pSentinels == NULL)
+	{ // Memory allocation failed.
+		return false;
+	}
+
+	*ppHead = &pSentinels[0];
+	*ppTail = &pSentinels[1];
+	(*ppHead)->pNext = *ppTail;
+	(*ppTail)->pPrevious = *ppHead;
+	return true;
+}
+
+///
+/// @fn	static void msgQueueFree(msg* pHead)
+///
+/// @brief	Frees the sentinels of a queue created by msgQueueCreate().
+///
+/// @param [in]	pHead	The head sentinel.
+///
+static void msgQueueFree(msg* pHead)
+{
+	kernelFree(pHead);
+}
+
+///
+/// @fn	static int msgHeight(msg* pMsg)
+///
+/// @brief	Gets the height of a subtree of a message queue.
+///
+/// @param [in]	pMsg	The root of the subtree, or NULL.
+///
+/// @return	The height, 0 for an empty subtree.
+///
+static int msgHeight(msg* pMsg)
+{
+	return (pMsg != NULL) ? pMsg->nHeight : 0;
+}
+
+///
+/// @fn	static void msgUpdateHeight(msg* pMsg)
+///
+/// @brief	Updates the height of a message from the heights of its children.
+///
+/// @param [in,out]	pMsg	The message.
+///
+static void msgUpdateHeight(msg* pMsg)
+{
+	int nLeft = msgHeight(pMsg->pLeft);
+	int nRight = msgHeight(pMsg->pRight);
+
+	pMsg->nHeight = 1 + ((nLeft > nRight) ? nLeft : nRight);
+}
+
+///
+/// @fn	static void msgReplaceChild(msg* pParent, msg* pOld, msg* pNew)
+///
+/// The head sentinel has no left child so the root is always replaced 
+/// in its right child.
+/// 
+/// @brief	Replaces a child of a message in the deadline tree.
+///
+/// @param [in,out]	pParent	The parent.
+/// @param [in]		pOld   	The child to replace.
+/// @param [in,out]	pNew   	The new child, or NULL.
+///
+static void msgReplaceChild(msg* pParent, msg* pOld, msg* pNew)
+{
+	if (pParent->pLeft == pOld)
+	{
+		pParent->pLeft = pNew;
+	}
+	else
+	{
+		pParent->pRight = pNew;
+	}
+
+	if (pNew != NULL)
+	{
+		pNew->pParent = pParent;
+	}
+}
+
+///
+/// @fn	static msg* msgRotate(msg* pMsg, bool bLeft)
+///
+/// @brief	Rotates a subtree of the deadline tree.
+///
+/// @param [in,out]	pMsg 	The root of the subtree.
+/// @param 		   	bLeft	True to rotate left, i.e. the right child becomes the root.
+///
+/// @return	The new root of the subtree.
+///
+static msg* msgRotate(msg* pMsg, bool bLeft)
+{
+	msg* pChild = bLeft ? pMsg->pRight : pMsg->pLeft;
+
+	msgReplaceChild(pMsg->pParent, pMsg, pChild);
+	if (bLeft)
+	{
+		pMsg->pRight = pChild->pLeft;
+		if (pMsg->pRight != NULL)
+		{
+			pMsg->pRight->pParent = pMsg;
+		}
+		pChild->pLeft = pMsg;
+	}
+	else
+	{
+		pMsg->pLeft = pChild->pRight;
+		if (pMsg->pLeft != NULL)
+		{
+			pMsg->pLeft->pParent = pMsg;
+		}
+		pChild->pRight = pMsg;
+	}
+	pMsg->pParent = pChild;
+
+	msgUpdateHeight(pMsg);
+	msgUpdateHeight(pChild);
+	return pChild;
+}
+
+///
+/// @fn	static void msgRebalance(msg* pMsg)
+///
+/// Restores the AVL balance of the deadline tree on the path from a 
+/// changed subtree to the head sentinel.
+/// 
+/// @brief	Rebalances the deadline tree of a message queue.
+///
+/// @param [in,out]	pMsg	The message whose subtree changed, or the head sentinel.
+///
+static void msgRebalance(msg* pMsg)
+{
+	// Only the head sentinel has no parent
+	while (pMsg->pParent != NULL)
+	{
+		int nLeft = msgHeight(pMsg->pLeft);
+		int nRight = msgHeight(pMsg->pRight);
+
+		if (nLeft > nRight + 1)
+		{
+			if (msgHeight(pMsg->pLeft->pLeft) < msgHeight(pMsg->pLeft->pRight))
+			{
+				msgRotate(pMsg->pLeft, true);
+			}
+			pMsg = msgRotate(pMsg, false);
+		}
+		else if (nRight > nLeft + 1)
+		{
+			if (msgHeight(pMsg->pRight->pRight) < msgHeight(pMsg->pRight->pLeft))
+			{
+				msgRotate(pMsg->pRight, false);
+			}
+			pMsg = msgRotate(pMsg, true);
+		}
+		else
+		{
+			msgUpdateHeight(pMsg);
+		}
+
+		pMsg = pMsg->pParent;
+	}
+}
+
+///
+/// @fn	static void msgDeadlineInsert(msg* pHead, msg* pNew)
+///
+/// Inserts a message of a blocked task in a queue of messages delimited by
+/// sentinels, ordered by the deadline of the blocked tasks. Tasks with
+/// equal deadlines are queued in FIFO order. The position is found in
+/// the deadline tree of the queue, so the cost grows with the logarithm
+/// of the number of waiting tasks.
+/// 
+/// @brief	Inserts a message in deadline order.
+///
+/// @param [in,out]	pHead	The head sentinel of the queue.
+/// @param [in,out]	pNew 	The message, pNew->pBlock must be set.
+///
+static void msgDeadlineInsert(msg* pHead, msg* pNew)
+{
+	msg* pParent = pHead;
+	msg* tmp = pHead->pRight;
+	bool bLeft = false;
+
+	while (tmp != NULL)
+	{
+		pParent = tmp;
+		bLeft = pNew->pBlock->pTask->DeadLine < tmp->pBlock->pTask->DeadLine;
+		tmp = bLeft ? tmp->pLeft : tmp->pRight;
+	}
+
+	pNew->pLeft = NULL;
+	pNew->pRight = NULL;
+	pNew->pParent = pParent;
+	pNew->nHeight = 1;
+
+	if (bLeft)
+	{ // Queue pNew just in front of its parent
+		pParent->pLeft = pNew;
+		pNew->pNext = pParent;
+		pNew->pPrevious = pParent->pPrevious;
+	}
+	else // Queue pNew just behind its parent
+	{
+		pParent->pRight = pNew;
+		pNew->pPrevious = pParent;
+		pNew->pNext = pParent->pNext;
+	}
+	pNew->pPrevious->pNext = pNew;
+	pNew->pNext->pPrevious = pNew;
+
+	msgRebalance(pParent);
+}
+
+///
+/// @fn	static void msgRemove(msg* pMsg)
+///
+/// @brief	Removes a message from the queue it is in.
+///
+/// @param [in,out]	pMsg	The message.
+///
+static void msgRemove(msg* pMsg)
+{
+	msg* pChanged = pMsg->pParent;
+
+	if (pMsg->pLeft == NULL || pMsg->pRight == NULL)
+	{
+		msgReplaceChild(pMsg->pParent, pMsg, 
+			(pMsg->pLeft != NULL) ? pMsg->pLeft : pMsg->pRight);
+	}
+	else // The next message is the leftmost of the right subtree, move it here
+	{
+		msg* pNext = pMsg->pNext;
+
+		if (pNext->pParent == pMsg)
+		{
+			pChanged = pNext;
+		}
+		else
+		{
+			pChanged = pNext->pParent;
+			msgReplaceChild(pNext->pParent, pNext, pNext->pRight);
+			pNext->pRight = pMsg->pRight;
+			pNext->pRight->pParent = pNext;
+		}
+
+		pNext->pLeft = pMsg->pLeft;
+		pNext->pLeft->pParent = pNext;
+		pNext->nHeight = pMsg->nHeight;
+		msgReplaceChild(pMsg->pParent, pMsg, pNext);
+	}
+	msgRebalance(pChanged);
+
+	pMsg->pPrevious->pNext = pMsg->pNext;
+	pMsg->pNext->pPrevious = pMsg->pPrevious;
+	pMsg->pNext = NULL;
+	pMsg->pPrevious = NULL;
+}
+
+///
+/// @fn	static void msgDeadlineChanged(listobj* pTask)
+///
+/// Requeues the messages a task is blocked on after its deadline changed,
+/// all of them for a receive_any() call. Interrupts must be disabled.
+/// 
+/// @brief	Restores the deadline order of the queues of a task.
+///
+/// @param [in,out]	pTask	The task.
+///
+static void msgDeadlineChanged(listobj* pTask)
+{
+	msg* pMsg = pTask->pMessage;
+
+	if (pMsg == NULL || pMsg->pNext == NULL)
+	{ // Not queued, or it has been received
+		return;
+	}
+
+	do
+	{
+		msg* pHead = pMsg->pParent;
+		while (pHead->pParent != NULL)
+		{ // Find the head sentinel of the queue
+			pHead = pHead->pParent;
+		}
+
+		msgRemove(pMsg);
+		msgDeadlineInsert(pHead, pMsg);
+
+		pMsg = pMsg->pSibling;
+	} while (pMsg != NULL && pMsg != pTask->pMessage);
+}
+
+///
+/// @fn	static void taskWake(listobj* pTask)
+///
+/// Moves a blocked task to the readyList. A task that waits with a 
+/// timeout is in the timerList, the others are in the waitingList.
+/// The task is already ready if its deadline or timeout was reached
+/// but it has not yet run to leave the queue it is blocked on.
+/// 
+/// @brief	Makes a blocked task ready.
+///
+/// @param [in,out]	pTask	The task.
+///
+static void taskWake(listobj* pTask)
+{
+	if (OSList_remove(waitingList, pTask) || OSList_remove(timerList, pTask))
+	{
+		cbsWake(pTask);
+		OSList_readyInsert(readyList, pTask);
+	}
+}
+
+///
+/// @fn	static listobj* msgWake(msg* pMsg)
+///
+/// Removes the message from its queue and moves the task that is blocked
+/// on it from the waitingList to the readyList.
+/// 
+/// @brief	Wakes the task blocked on a message.
+///
+/// @param [in,out]	pMsg	The message.
+///
+/// @return	The woken task.
+///
+static listobj* msgWake(msg* pMsg)
+{
+	listobj* task = pMsg->pBlock;
+
+	msgRemove(pMsg);
+	pMsg->Status = SUCCESS;
+	task->pMessage = NULL;
+	taskWake(task);
+
+	return task;
+}
+
+///
+/// @fn	static bool isReady(listobj* pTask)
+///
+/// @brief	Checks if a task is in the readyList.
+///
+/// @param [in]	pTask	The task.
+///
+/// @return	True if the task is in the readyList.
+///
+static bool isReady(listobj* pTask)
+{
+	return OSList_contains(readyList, pTask);
+}
+
+///
+/// @fn	static listobj* pickNext(void)
+///
+/// Returns the task in the readyList with the earliest deadline that is 
+/// allowed to execute under the Stack Resource Policy, i.e. either it
+/// holds a mutex or its preemption level is above the system ceiling.
+/// The running task keeps the cpu if that task does not pass its 
+/// preemption threshold.
+/// 
+/// @brief	Picks the next task to execute.
+///
+/// @return	The next task to execute.
+///
+static listobj* pickNext(void)
+{
+	listobj* tmp = OSList_readyPeek(readyList);
+
+	if (systemCeiling != UINT32_MAX)
+	{ // A mutex is locked
+		while (tmp != NULL && tmp->nLocks == 0 && tmp->nRelDeadline >= systemCeiling)
+		{
+			tmp = tmp->pNext;
+		}
+
+		// If the mutex owner is blocked nothing may run but the idle
+		// task, which always has the latest deadline.
+		if (tmp == NULL)
+		{
+			tmp = readyList->pTail;
+		}
+	}
+
+	if (tmp != runningListobj && runningListobj->nThreshold != 0 
+		&& tmp->nPreemptClass <= runningListobj->nPreemptClass
+		&& OSList_readyKey(runningListobj) - OSList_readyKey(tmp) <= runningListobj->nThreshold
+		&& isReady(runningListobj))
+	{ // Not earlier by more than the threshold
+		return runningListobj;
+	}
+
+	return tmp;
+}
+
+///
+/// @fn	static void schedulingUpdate(void)
+///
+/// @brief	Scheduling update.
+///
+/// @author	Albin Hjalmas.
+/// @date	1/30/2017
+///
+static void schedulingUpdate(void)
+{
+	// Move released tasks to the readyList
+	releaseTasks();
+
+	// Handle tasks that are still ready after their deadline
+	applyOverrunPolicies();
+
+	// Set the currently running task
+	setRunningTask(pickNext());
+	needPreempt = false;
+}
+
+///
+/// @fn	static void contextSwitch(void)
+///
+/// Saves the context of the running task, makes a scheduling update and
+/// loads the context of the task it chose. The calling task returns from
+/// this function when it is loaded again. Must be called with interrupts
+/// disabled, they are enabled on return.
+/// 
+/// @brief	Switches to the next task.
+///
+static void contextSwitch(void)
+{
+	volatile bool firstExecution = true;
+	SaveContext();
+
+	if (firstExecution)
+	{
+		firstExecution = !firstExecution;
+		schedulingUpdate(); // initiate context-switch
+		LoadContext(); // Commit context-switch and reenable interrupts
+	}
+}
+
+///
+/// @fn	static void reschedule(void)
+///
+/// Called by the kernel functions after they changed the state of tasks,
+/// the save and restore of a context switch is skipped if the calling 
+/// task remains the task to run. Must be called with interrupts 
+/// disabled, they are enabled on return.
+/// 
+/// @brief	Switches to the next task if it is not the calling task.
+///
+static void reschedule(void)
+{
+	if (pickNext() == runningListobj)
+	{ // No context switch needed
+		isr_on();
+		return;
+	}
+
+	contextSwitch();
+}
+
+static void idleTask(void);
+
+///
+/// @fn	static bool runIdleHooks(void)
+///
+/// Runs each armed idle hook once, stops early if a task has become 
+/// ready. A hook that has no more work is disarmed so that it is not
+/// polled on every wake up of the idle task.
+/// 
+/// @brief	Runs the idle hooks.
+///
+/// @return	True if any hook has more work to do.
+///
+static bool runIdleHooks(void)
+{
+	bool pending = false;
+
+	for (uint i = 0; i < nIdleHooks && Running->PC == idleTask; i++)
+	{
+		if (!idleHooks[i].bArmed)
+		{
+			continue;
+		}
+
+		// Disarm first, arm_idle_hook() may be called while the hook runs
+		idleHooks[i].bArmed = false;
+		idleHookStart = osTicks;
+		idleHookQuantum = idleHooks[i].nQuantum;
+		if (idleHooks[i].pHook())
+		{
+			idleHooks[i].bArmed = true;
+			pending = true;
+		}
+	}
+
+	return pending;
+}
+
+///
+/// @fn	static bool idleHookArmed(void)
+///
+/// @brief	Checks if a hook was armed after runIdleHooks() returned.
+///
+/// @return	True if any idle hook is armed.
+///
+static bool idleHookArmed(void)
+{
+	for (uint i = 0; i < nIdleHooks; i++)
+	{
+		if (idleHooks[i].bArmed)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+///
+/// @fn	static void idleTask(void)
+///
+/// The idle task never spins, it puts the cpu to sleep (WFI) on Cortex-M
+/// and blocks on an event on x86 until the timer interrupt has handed the
+/// cpu over to another task.
+/// 
+/// @brief	Idle task.
+///
+/// @author	Albin Hjalmas.
+/// @date	1/30/2017
+///
+static void idleTask(void)
+{
+	while (true)
+	{
+		if (Running->PC != idleTask)
+		{ // This means that the timer interrupt has 
+		  // induced a context switch
+			isr_off();		// disable interrupts
+			LoadContext();  // load context and reenable interrupts
+		}
+
+		if (runIdleHooks())
+		{ // Background work remains, dont go to sleep.
+			continue;
+		}
+
+#ifdef _X86_
+		// Sleep until isrSchedulingUpdate() signals that a task is ready.
+		WaitForSingleObject(idleEvent, INFINITE);
+#elif _CORTEX_M_
+		// PRIMASK keeps the interrupt that wakes the cpu
+		// pending until Running has been checked once more.
+		__disable_irq();
+		if (Running->PC == idleTask && !idleHookArmed())
+		{ // Still nothing to do, sleep until the next interrupt.
+			__DSB();
+			__WFI();
+		}
+		__enable_irq();
+#endif
+	}
+}
+
+///
+/// @fn	static void isrSchedulingUpdate(void)
+///
+/// Scheduling update from interrupt context. The cpu is only handed 
+/// over to a new task when the idle task is running since a running 
+/// task switches context itself the next time it calls the kernel, 
+/// at which point released tasks are taken into account.
+/// 
+/// @brief	Scheduling update from interrupt context.
+///
+static void isrSchedulingUpdate(void)
+{
+	if (Running->PC == idleTask)
+	{
+		setRunningTask(pickNext());
+
+#ifdef _X86_
+		if (Running->PC != idleTask)
+		{ // Wake the idle task so that it loads the new task.
+			SetEvent(idleEvent);
+		}
+#endif
+	}
+}
+
+///
+/// @fn	static void ttDispatcher(void)
+///
+/// Runs the slots that the tick has handed over and then hands the cpu 
+/// back to the idle task until the next slot. The bodies run to completion.
+/// 
+/// @brief	The dispatcher task of the time-triggered mode.
+///
+static void ttDispatcher(void)
+{
+	while (true)
+	{
+		isr_off();
+
+		if (ttPending == 0)
+		{ // Sleep until the next slot
+			volatile bool firstExecution = true;
+			SaveContext();
+
+			if (firstExecution)
+			{
+				firstExecution = !firstExecution;
+				setRunningTask(idleListobj);
+				LoadContext(); // Commit context-switch and reenable interrupts
+			}
+			continue;
+		}
+
+		ttslot* slot = &ttTable[ttRun];
+		ttRun = (ttRun + 1 == ttSlots) ? 0 : ttRun + 1;
+		ttPending--;
+
+		isr_on();
+		slot->pBody();
+	}
+}
+
+///
+/// @fn	static void ttTick(void)
+///
+/// Indexes the dispatch table in constant time and hands the slot to 
+/// the dispatcher task, no list is searched or sorted. Slots that are due 
+/// while a previous one is still running are run right after it.
+/// 
+/// @brief	Tick of the time-triggered mode.
+///
+static void ttTick(void)
+{
+	if (ttTable[ttNext].nOffset == ttPhase)
+	{
+		ttPending++;
+		ttNext = (ttNext + 1 == ttSlots) ? 0 : ttNext + 1;
+
+		if (Running->PC == idleTask)
+		{
+			setRunningTask(ttListobj);
+#ifdef _X86_
+			SetEvent(idleEvent); // Wake the idle task so that it loads the dispatcher.
+#endif
+		}
+	}
+
+	ttPhase = (ttPhase + 1 == ttHyperperiod) ? 0 : ttPhase + 1;
+}
+
+///
+/// @fn	static bool sliceTick(void)
+///
+/// Charges one tick to the time slice of the running task. When the slice
+/// is used up and the next task in the readyList has the same deadline,
+/// the running task is moved behind the tasks with its deadline. The 
+/// EDF order is kept, tasks with equal deadlines share the cpu in turns.
+/// 
+/// @brief	Rotates tasks with equal deadlines.
+///
+/// @return	True if the running task was moved.
+///
+static bool sliceTick(void)
+{
+	if (sliceLength == 0)
+	{ // Time slicing is disabled
+		return false;
+	}
+
+	if (runningListobj != sliceOwner)
+	{ // A new slice
+		sliceOwner = runningListobj;
+		sliceTicks = 0;
+	}
+
+	if (++sliceTicks < sliceLength || runningListobj->pNext == NULL
+		|| OSList_readyKey(runningListobj->pNext) != OSList_readyKey(runningListobj)
+		|| !isReady(runningListobj))
+	{
+		return false;
+	}
+
+	sliceTicks = 0;
+	OSList_readyRemove(readyList, runningListobj);
+	OSList_readyInsert(readyList, runningListobj);
+	return true;
+}
+
+///
+/// @fn	static bool timerTick(void)
+///
+/// @brief	Increments the system ticks and releases tasks.
+///
+/// @author	Albin Hjalmas
+/// @date	1/30/2017
+///
+/// @return	True if the running task must be preempted.
+///
+static bool timerTick(void)
+{
+	osTicks++;
+
+	if (ttTable != NULL)
+	{ // Time-triggered mode, no EDF decisions
+		ttTick();
+		return false;
+	}
+
+	bool moved = OSList_readyTick(readyList);
+	moved = cbsCharge() || moved;
+	moved = sliceTick() || moved;
+	if (moved)
+	{
+		needPreempt = true;
+	}
+	releaseTasks();
+	isrSchedulingUpdate();
+
+	if (preemptPending || Running->PC == idleTask)
+	{
+		return false;
+	}
+
+	// Tasks normally switch context themselves, the tick only takes the 
+	// cpu from a task that has been moved behind another task or that
+	// overran its deadline, the overrun policy is applied by the switch
+	return (needPreempt && pickNext() != runningListobj) || overrunPending(runningListobj);
+}
+
+///
+/// @fn	void kernelPreempt(void)
+///
+/// Entered through PreemptTrampoline by a task that the tick has 
+/// redirected, the trampoline preserves the registers of the task
+/// that a function call would not.
+/// 
+/// @brief	Switches from a preempted task.
+///
+void kernelPreempt(void)
+{
+	isr_off();
+	preemptPending = false;
+	needPreempt = false;
+
+	contextSwitch();
+}
+
+#ifdef _X86_
+///
+/// @fn	void timerInterrupt(void)
+///
+/// The thread executing the tasks is suspended during the tick, as a task
+/// would be by an interrupt. To preempt the running task its instruction
+/// pointer is pushed on its stack and it is redirected to PreemptTrampoline.
+/// 
+/// @brief	Timer interrupt thread.
+///
+/// @author	Albin Hjalmas
+/// @date	1/30/2017
+///
+void timerInterrupt(void)
+{
+	CONTEXT ctx;
+
+	while (true)
+	{
+		// Sleep for 20ms
+		Sleep(20);
+
+		SuspendThread(mainThread);
+
+		if (isrOnState && timerTick())
+		{ // Only execute this if interrupts is turned on.
+			ctx.ContextFlags = CONTEXT_CONTROL;
+			if (GetThreadContext(mainThread, &ctx))
+			{
+				ctx.Esp -= sizeof(DWORD);
+				*(DWORD*)ctx.Esp = ctx.Eip; // Return address of the trampoline
+				ctx.Eip = (DWORD)PreemptTrampoline;
+				preemptPending = true;
+				SetThreadContext(mainThread, &ctx);
+			}
+		}
+
+		ResumeThread(mainThread);
+	}
+}
+#elif _CORTEX_M_
+///
+/// @fn	void kernelTick(uint* pFrame)
+///
+/// Called by SysTick_Handler with the exception frame of the interrupted
+/// task. To preempt the task the stacked PC is replaced by 
+/// PreemptTrampoline, unless the task was interrupted inside an IT block
+/// or a multiple load/store in which case it is preempted at a later tick.
+/// 
+/// @brief	The tick interrupt.
+///
+/// @param [in,out]	pFrame	The exception frame, r0-r3, r12, lr, pc, xPSR.
+///
+void kernelTick(uint* pFrame)
+{
+	if (timerTick() && (pFrame[7] & (XPSR_ICI_IT_Msk | XPSR_IPSR_Msk)) == 0)
+	{
+		preemptPC = pFrame[6];
+		pFrame[6] = ((uint)(uintptr_t)PreemptTrampoline) & ~1UL; // Without the thumb bit
+		preemptPending = true;
+	}
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+///				Task administration Function definitions.
+//////////////////////////////////////////////////////////////////////////////
+
+///
+/// @fn	int init_kernel(void);
+///
+/// @brief	Init kernel.
+///
+/// @date	1/30/2017
+///
+/// @return	FAIL if failed or SUCCESS if successful.
+///
+exception init_kernel(void)
+{
+	osTicks = 0;
+
+	// Create readyList
+	if ((readyList = OSList_create()) == NULL)
+	{ // Unable to allocate memory for list.
+		return FAIL;
+	}
+
+	// Create waitingList
+	if ((waitingList = OSList_create()) == NULL)
+	{ // Unable to allocate memory for list.
+		free(readyList);
+		return FAIL;
+	}
+
+	// Create timerList
+	if ((timerList = OSList_create()) == NULL)
+	{ // Unable to allocate memory for list.
+		free(readyList);
+		free(waitingList);
+		return FAIL;
+	}
+
+	// Create freeList
+	if ((freeList = OSList_create()) == NULL)
+	{ // Unable to allocate memory for list.
+		free(readyList);
+		free(waitingList);
+		free(timerList);
+		return FAIL;
+	}
+
+	// Create the idle task
+	listobj* idleTaskOb = OSList_createListobj();
+	if (idleTaskOb == NULL)
+	{ // Something went wrong
+		free(readyList);
+		free(waitingList);
+		free(timerList);
+		free(freeList);
+		return FAIL;
+	}
+
+	// Initialize the idle task
+	initTask(idleTaskOb, idleTask, UINT32_MAX);
+	idleTaskOb->nRelDeadline = UINT32_MAX;
+	idleTaskOb->nPriority = SCHED_PRIORITIES - 1;
+	systemCeiling = UINT32_MAX;
+
+	if (!OSList_readyInsert(readyList, idleTaskOb))
+	{ // Something went wrong!
+		free(readyList);
+		free(waitingList);
+		free(timerList);
+		free(freeList);
+		free(idleTaskOb);
+		return FAIL;
+	}
+
+	// Set the currently running task
+	setRunningTask(idleTaskOb);
+	idleListobj = idleTaskOb;
+	ttTable = NULL;
+	admittedTasks = NULL;
+	admittedCount = 0;
+	admittedUtil = 0;
+	admittedDensity = 0;
+
+	// Set kernel operating mode.
+	opMode = INIT;
+
+	return SUCCESS;
+}
+
+///
+/// @fn	exception create_task(void(*body)(), uint d)
+///
+/// @brief	Creates a task, Requires that init_kernel() have been executed.
+///
+/// @author	Albin Hjalmas.
+/// @date	1/30/2017
+///
+/// @param [in,out]	body	If non-null, the body.
+/// @param 		   	d   	The deadline.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception create_task(void(*body)(), uint d)
+{
+	// must pass a valid function
+	// body. and delay time cannot be 0.
+	// Also check if the OSList's has been properly
+	// initialized.
+	if (body == NULL || d == 0 || readyList == NULL 
+		|| waitingList == NULL || timerList == NULL
+		|| freeList == NULL || opMode == UNINITIALIZED || d < 0
+		|| ttTable != NULL)
+	{
+		return FAIL;
+	}
+
+	// Recycle a terminated task if there is one, else create the task.
+	// The task is set up in one critical section so that the tick can 
+	// not restart the caller while it holds a task that is in no list.
+	isr_off();
+	listobj* task = OSList_getFirst(freeList);
+
+	if (task == NULL && (task = kernelCreateListobj()) == NULL)
+	{ // Unable to allocate memory.
+		isr_on();
+		return FAIL;
+	}
+
+	// Initialize task
+	initTask(task, body, d);
+	task->nRelDeadline = d > osTicks ? d - osTicks : 1;
+	task->nLocks = 0;
+
+	// Insert task in ready-list
+	if (!OSList_readyInsert(readyList, task)) 
+	{ // Something went wrong!
+		OSList_frontInsert(freeList, task);
+		isr_on();
+		return FAIL;
+	}
+
+	if (opMode == INIT)
+	{ // No context switch needed
+		isr_on();
+		return SUCCESS;
+	}
+
+	// Switch if the new task preempts the caller
+	reschedule();
+
+	// The creation of a task was successful!
+	return SUCCESS;
+}
+
+///
+/// @fn	static exception createPeriodicTask(void(*body)(), uint nWcet, uint nPeriod, uint nRelDeadline, uint nOffset)
+///
+/// @brief	Creates a periodic task, admitted if nWcet is not 0.
+///
+/// @param [in,out]	body			If non-null, the body.
+/// @param 		   	nWcet			The worst case execution time, 0 if not admitted.
+/// @param 		   	nPeriod			The period.
+/// @param 		   	nRelDeadline	The deadline relative to each release.
+/// @param 		   	nOffset			The first release relative to now.
+///
+/// @return	FAIL or SUCCESS.
+///
+static exception createPeriodicTask(void(*body)(), uint nWcet, uint nPeriod, uint nRelDeadline, uint nOffset)
+{
+	if (body == NULL || nPeriod == 0 || nRelDeadline == 0 || readyList == NULL
+		|| waitingList == NULL || timerList == NULL
+		|| freeList == NULL || opMode == UNINITIALIZED || ttTable != NULL)
+	{
+		return FAIL;
+	}
+
+	// Recycle a terminated task if there is one, else create the task.
+	// The task is set up in one critical section so that the tick can 
+	// not restart the caller while it holds a task that is in no list.
+	isr_off();
+	listobj* task = OSList_getFirst(freeList);
+
+	if (task == NULL && (task = kernelCreateListobj()) == NULL)
+	{ // Unable to allocate memory.
+		isr_on();
+		return FAIL;
+	}
+
+	// Initialize task
+	uint release = osTicks + nOffset;
+	initTask(task, body, release + nRelDeadline);
+	task->nRelDeadline = nRelDeadline;
+	task->nLocks = 0;
+	task->nPeriod = nPeriod;
+	task->nRelease = release;
+	task->nWcet = nWcet;
+
+	if (nWcet != 0 && !admit(task))
+	{ // The task set would not be schedulable
+		OSList_frontInsert(freeList, task);
+		isr_on();
+		return FAIL;
+	}
+
+	if (nOffset == 0)
+	{ // The first job is released now
+		OSList_readyInsert(readyList, task);
+	}
+	else
+	{
+		OSList_timerInsertAt(timerList, task, release);
+	}
+
+	if (opMode == INIT)
+	{ // No context switch needed
+		isr_on();
+		return SUCCESS;
+	}
+
+	reschedule();
+	return SUCCESS;
+}
+
+
+///
+/// @fn	exception create_periodic_task(void(*body)(), uint nPeriod, uint nRelDeadline, uint nOffset)
+///
+/// Creates a periodic task. Release times and deadlines are computed from
+/// the first release so they never drift, the task is kept in the timerList
+/// until it is released.
+/// 
+/// @brief	Creates a periodic task, requires that init_kernel() have been executed.
+///
+/// @param [in,out]	body			If non-null, the body.
+/// @param 		   	nPeriod			The period.
+/// @param 		   	nRelDeadline	The deadline relative to each release.
+/// @param 		   	nOffset			The first release relative to now.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception create_periodic_task(void(*body)(), uint nPeriod, uint nRelDeadline, uint nOffset)
+{
+	return createPeriodicTask(body, 0, nPeriod, nRelDeadline, nOffset);
+}
+
+///
+/// @fn	exception create_admitted_task(void(*body)(), uint nWcet, uint nPeriod, uint nRelDeadline, uint nOffset)
+///
+/// Creates a periodic task if the admitted tasks, including CBS tasks,
+/// remain schedulable by EDF with the new task. Tasks created by other
+/// means are not accounted for. A task set that needs a processor demand
+/// test over more than ADMISSION_MAX_INTERVAL ticks is rejected.
+/// 
+/// @brief	Creates a periodic task after an admission test.
+///
+/// @param [in,out]	body			If non-null, the body.
+/// @param 		   	nWcet			The worst case execution time of a job.
+/// @param 		   	nPeriod			The period.
+/// @param 		   	nRelDeadline	The deadline relative to each release.
+/// @param 		   	nOffset			The first release relative to now.
+///
+/// @return	FAIL if the arguments are bad, the task is rejected or
+/// 		SCHED_POLICY is not SCHED_EDF else SUCCESS.
+///
+exception create_admitted_task(void(*body)(), uint nWcet, uint nPeriod, uint nRelDeadline, uint nOffset)
+{
+	if (nWcet == 0 || SCHED_POLICY != SCHED_EDF)
+	{ // The admission test assumes EDF
+		return FAIL;
+	}
+
+	return createPeriodicTask(body, nWcet, nPeriod, nRelDeadline, nOffset);
+}
+
+///
+/// @fn	exception create_cbs_task(void(*body)(), uint nBudget, uint nPeriod)
+///
+/// Creates a task served by a Constant Bandwidth Server with bandwidth 
+/// nBudget / nPeriod. Every tick the task runs is charged to the budget,
+/// when the budget is exhausted the deadline is postponed by one period
+/// and the task is preempted if that puts another task in front of it.
+/// The task thereby never takes more than its bandwidth from tasks with 
+/// earlier deadlines, however long it runs.
+/// 
+/// @brief	Creates a CBS task, requires that init_kernel() have been executed.
+///
+/// @param [in,out]	body   	If non-null, the body.
+/// @param 		   	nBudget	The budget in ticks per period.
+/// @param 		   	nPeriod	The period of the server.
+///
+/// @return	FAIL if SCHED_POLICY is not SCHED_EDF or the task can not be
+/// 		created else SUCCESS.
+///
+exception create_cbs_task(void(*body)(), uint nBudget, uint nPeriod)
+{
+	if (body == NULL || nBudget == 0 || nPeriod < nBudget || readyList == NULL
+		|| waitingList == NULL || timerList == NULL
+		|| freeList == NULL || opMode == UNINITIALIZED || ttTable != NULL
+		|| SCHED_POLICY != SCHED_EDF)
+	{ // A postponed deadline only isolates the server under EDF
+		return FAIL;
+	}
+
+	// Recycle a terminated task if there is one, else create the task.
+	// The task is set up in one critical section so that the tick can 
+	// not restart the caller while it holds a task that is in no list.
+	isr_off();
+	listobj* task = OSList_getFirst(freeList);
+
+	if (task == NULL && (task = kernelCreateListobj()) == NULL)
+	{ // Unable to allocate memory.
+		isr_on();
+		return FAIL;
+	}
+
+	// Initialize task, the server starts with a full budget
+	initTask(task, body, osTicks + nPeriod);
+	task->nRelDeadline = nPeriod;
+	task->nLocks = 0;
+	task->nCbsBudget = nBudget;
+	task->nCbsRemaining = nBudget;
+	task->nCbsPeriod = nPeriod;
+	task->nWcet = nBudget;
+
+	if (!admit(task))
+	{ // The bandwidth is not available
+		OSList_frontInsert(freeList, task);
+		isr_on();
+		return FAIL;
+	}
+
+	OSList_readyInsert(readyList, task);
+
+	if (opMode == INIT)
+	{ // No context switch needed
+		isr_on();
+		return SUCCESS;
+	}
+
+	reschedule();
+	return SUCCESS;
+}
+
+///
+/// @fn	exception wait_next_period(void)
+///
+/// Ends the current job of a periodic task. The task is moved from the 
+/// readyList to the timerList until its next release, if the next
+/// release has already passed the task stays ready.
+/// 
+/// @brief	Waits for the next release of a periodic task.
+///
+/// @return	FAIL if the task is not periodic, DEADLINE_REACHED if the job
+/// 		finished after its deadline else SUCCESS.
+///
+exception wait_next_period(void)
+{
+	if (Running == NULL || runningListobj->nPeriod == 0)
+	{
+		return FAIL;
+	}
+
+	isr_off();
+
+	exception res = (Running->DeadLine <= osTicks) ? DEADLINE_REACHED : SUCCESS;
+
+	// Compute the next release and deadline from the previous release
+	runningListobj->nRelease += runningListobj->nPeriod;
+	Running->DeadLine = runningListobj->nRelease + runningListobj->nRelDeadline;
+
+	OSList_readyRemove(readyList, runningListobj);
+	if (runningListobj->nRelease <= osTicks)
+	{ // The next job has already been released
+		OSList_readyInsert(readyList, runningListobj);
+	}
+	else
+	{
+		OSList_timerInsertAt(timerList, runningListobj, runningListobj->nRelease);
+	}
+
+	reschedule();
+	return res;
+}
+
+///
+/// @fn	exception set_overrun_policy(uint nPolicy, uint (*handler)(listobj* pTask))
+///
+/// The policy is applied when the task is still ready at its deadline,
+/// either by the tick while it runs or by the next scheduling decision.
+/// OVERRUN_SKIP drops the job and restarts the body at the next release 
+/// of a periodic task. OVERRUN_ABORT restarts the body at once with the
+/// relative deadline of the task. OVERRUN_DEMOTE lets the task continue 
+/// after all other tasks, it is only available under SCHED_EDF since the 
+/// other policies do not order the tasks by deadline. OVERRUN_HANDLER 
+/// calls the handler, with interrupts disabled, which returns the new
+/// deadline of the task, a deadline that has already passed demotes the
+/// task (under SCHED_DM and SCHED_FP it only ends the overrun). A 
+/// restarted task must not rely on anything on its stack.
+/// 
+/// @brief	Sets the overrun policy of the calling task.
+///
+/// @param 		   	nPolicy	The policy.
+/// @param [in]	   	handler	The handler, only used with OVERRUN_HANDLER.
+///
+/// @return	FAIL if the policy does not apply to the task else SUCCESS.
+///
+exception set_overrun_policy(uint nPolicy, uint (*handler)(listobj* pTask))
+{
+	if (Running == NULL || Running->PC == idleTask || nPolicy > OVERRUN_HANDLER
+		|| (nPolicy == OVERRUN_SKIP && runningListobj->nPeriod == 0)
+		|| (nPolicy == OVERRUN_HANDLER && handler == NULL)
+		|| (nPolicy == OVERRUN_DEMOTE && SCHED_POLICY != SCHED_EDF))
+	{
+		return FAIL;
+	}
+
+	isr_off();
+	runningListobj->nOverrunPolicy = nPolicy;
+	runningListobj->pOverrunHandler = handler;
+	isr_on();
+
+	return SUCCESS;
+}
+
+///
+/// @fn	exception set_time_triggered(ttslot* pTable, uint nSlots, uint nHyperperiod)
+///
+/// Switches the kernel to the time-triggered mode. The tick dispatches 
+/// the slots of the table to a dispatcher task without any scheduling 
+/// decisions, the table is repeated every hyperperiod. Offsets count 
+/// from the first tick after run().
+/// 
+/// @brief	Installs a time-triggered dispatch table.
+///
+/// @param [in]	pTable			If non-null, the table sorted by offset.
+/// @param 		nSlots			The number of slots.
+/// @param 		nHyperperiod	The hyperperiod in ticks.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception set_time_triggered(ttslot* pTable, uint nSlots, uint nHyperperiod)
+{
+	// Only before run() and when no tasks have been created
+	if (pTable == NULL || nSlots == 0 || nHyperperiod == 0 || opMode != INIT
+		|| readyList == NULL || readyList->size != 1 || ttTable != NULL)
+	{
+		return FAIL;
+	}
+
+	// Offsets must be increasing and within the hyperperiod
+	for (uint i = 0; i < nSlots; i++)
+	{
+		if (pTable[i].pBody == NULL || pTable[i].nOffset >= nHyperperiod
+			|| (i > 0 && pTable[i].nOffset <= pTable[i - 1].nOffset))
+		{
+			return FAIL;
+		}
+	}
+
+	if (ttListobj == NULL && (ttListobj = kernelCreateListobj()) == NULL)
+	{ // Unable to allocate memory.
+		return FAIL;
+	}
+
+	// The dispatcher is never in any list
+	initTask(ttListobj, ttDispatcher, UINT32_MAX);
+	ttListobj->nRelDeadline = UINT32_MAX;
+	ttListobj->nPriority = SCHED_PRIORITIES - 1;
+
+	ttSlots = nSlots;
+	ttHyperperiod = nHyperperiod;
+	ttNext = 0;
+	ttPhase = 0;
+	ttPending = 0;
+	ttRun = 0;
+	ttTable = pTable;
+
+	return SUCCESS;
+}
+
+///
+/// @fn	void terminate(void)
+///
+/// Mutexes still held by the task are unlocked, so that the system
+/// ceiling does not hold back other tasks forever. The caller of a call
+/// that was not replied to is woken and its call() fails.
+/// 
 /// @brief	Terminates the currently running task.
 ///
-/// @author	Albin Hjalmas
-/// @date	1/30/2017
+/// @author	Albin Hjalmas
+/// @date	1/30/2017
+///
+void terminate(void)
+{
+	// Disable interrupts
+	isr_off();
+
+	// Check os operating mode
+	if (opMode != RUNNING || Running == NULL) 
+	{ // The os is not running, so there is nothing to terminate
+		isr_on();
+		return;
+	}
+
+	OSList_readyRemove(readyList, runningListobj); // Remove currently running task from readylist
+	dismiss(runningListobj);
+
+	// Unlock held mutexes, the first one locked restores the ceiling
+	while (runningListobj->pLocked != NULL)
+	{
+		mutex* pMutex = runningListobj->pLocked;
+		pMutex->pOwner = NULL;
+		systemCeiling = pMutex->nPrevCeiling;
+		runningListobj->pLocked = pMutex->pPrevLocked;
+	}
+	runningListobj->nLocks = 0;
+
+	if (runningListobj->pCall != NULL)
+	{ // The caller waits outside of all lists
+		runningListobj->pCall->Status = NO_REPLY;
+		OSList_readyInsert(readyList, runningListobj->pCall->pBlock);
+		runningListobj->pCall = NULL;
+	}
+
+	// Keep the listobj, TCB and stack for the next create_task().
+	// The stack is still in use until LoadContext() but nothing
+	// can reuse it while interrupts are disabled.
+	OSList_frontInsert(freeList, runningListobj);
+	setRunningTask(pickNext()); // Set running task to be the next in readylist.
+	
+	// Switch to new task
+	LoadContext();
+}
+
+///
+/// @fn	void run(void)
+///
+/// @brief	Starts the kernel.
+///
+/// @author	Albin Hjalmas.
+/// @date	1/30/2017
+///
+void run(void)
+{
+	// Disable interrupts
+	isr_off();
+	
+	// Check that the kernel has been properly
+	// initialized before continuing with this function.
+	if (opMode != INIT || readyList == NULL || waitingList == NULL ||
+		timerList == NULL || freeList == NULL || readyList->size == 0)
+	{
+		isr_on();
+		return;
+	}
+
+	// Initialize timer interrupt
+#ifdef _X86_
+	if (idleEvent == NULL)
+	{ // Auto-reset event, a wake up is never lost if it is signaled
+	  // before the idle task starts waiting.
+		idleEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	}
+	if (mainThread == NULL)
+	{ // The timer thread suspends this thread during the tick
+		DuplicateHandle(GetCurrentProcess(), GetCurrentThread(), GetCurrentProcess(),
+			&mainThread, 0, FALSE, DUPLICATE_SAME_ACCESS);
+	}
+	_beginthread(timerInterrupt, 1000, NULL);
+#elif _CORTEX_M_
+	uint32_t prioritygroup = 0x00U;
+	prioritygroup = NVIC_GetPriorityGrouping();
+	// The tick calls into the kernel and must therefore be masked by 
+	// kernel critical sections, give it the lowest priority.
+	NVIC_SetPriority(SysTick_IRQn, NVIC_EncodePriority(prioritygroup, (1UL << __NVIC_PRIO_BITS) - 1, 0));
+	SysTick_Config(SystemCoreClock / 50); // 20ms 
+#ifdef _CORTEX_M_FPU_
+	// Give all tasks access to the FPU and enable automatic FPU state
+	// preservation with lazy stacking. An interrupt that never executes
+	// a FPU instruction will not have to stack s0-s15 and SaveContext only
+	// saves s16-s31 for tasks that have set CONTROL.FPCA.
+	SCB->CPACR |= (0xFUL << 20);		// CP10 and CP11 full access
+	FPU->FPCCR |= FPU_FPCCR_ASPEN_Msk | FPU_FPCCR_LSPEN_Msk;
+	__DSB();
+	__ISB();
+#endif
+#endif
+
+	// Set the Running* pointer to the task
+	// with the earliest deadline.
+	setRunningTask(pickNext());
+
+	// Set the kernel operating mode to RUNNING
+	opMode = RUNNING;
+
+	// Enable interrupts
+	isr_on();
+
+	// Jump to current task.
+	LoadContext();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+///							Idle hook function definitions.
+//////////////////////////////////////////////////////////////////////////////
+
+///
+/// @fn	exception add_idle_hook( bool (*hook)(void), uint nQuantum );
+///
+/// @brief	Registers an idle hook.
+///
+/// @param	hook		The hook.
+/// @param	nQuantum	The maximum number of ticks the hook may run per call.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception add_idle_hook(bool (*hook)(void), uint nQuantum)
+{
+	// Check parameters
+	if (hook == NULL || nQuantum == 0 || nIdleHooks >= MAX_IDLE_HOOKS)
+	{
+		return FAIL;
+	}
+
+	isr_off();
+	idleHooks[nIdleHooks].pHook = hook;
+	idleHooks[nIdleHooks].nQuantum = nQuantum;
+	idleHooks[nIdleHooks].bArmed = true;
+	nIdleHooks++;
+	isr_on();
+
+	return SUCCESS;
+}
+
+///
+/// @fn	exception remove_idle_hook( bool (*hook)(void) );
+///
+/// @brief	Unregisters an idle hook.
+///
+/// @param	hook	The hook.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception remove_idle_hook(bool (*hook)(void))
+{
+	isr_off();
+	for (uint i = 0; i < nIdleHooks; i++)
+	{
+		if (idleHooks[i].pHook == hook)
+		{ // Move the last hook into the freed slot
+			idleHooks[i] = idleHooks[--nIdleHooks];
+			isr_on();
+			return SUCCESS;
+		}
+	}
+	isr_on();
+
+	return FAIL;
+}
+
+///
+/// @fn	exception arm_idle_hook( bool (*hook)(void) );
+///
+/// @brief	Arms an idle hook that has new work.
+///
+/// @param	hook	The hook.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception arm_idle_hook(bool (*hook)(void))
+{
+	isr_off();
+	for (uint i = 0; i < nIdleHooks; i++)
+	{
+		if (idleHooks[i].pHook == hook)
+		{
+			idleHooks[i].bArmed = true;
+#ifdef _X86_
+			if (Running != NULL && Running->PC == idleTask)
+			{ // Wake the idle task so that it runs the hook.
+				SetEvent(idleEvent);
+			}
+#endif
+			isr_on();
+			return SUCCESS;
+		}
+	}
+	isr_on();
+
+	return FAIL;
+}
+
+///
+/// @fn	bool idle_hook_expired( void );
+///
+/// @brief	Returns true when the executing idle hook must return.
+///
+/// @return	True if a task is ready or the quantum of the hook has elapsed.
+///
+bool idle_hook_expired(void)
+{
+	return Running->PC != idleTask || (osTicks - idleHookStart) >= idleHookQuantum;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+///							Timing function definitions.
+//////////////////////////////////////////////////////////////////////////////
+
+///
+/// @fn	exception wait( uint nTicks );
+///
+/// @brief	Causes the calling task to wait for a period of nTicks.
+/// @param	nTicks	Waiting period.
+///
+/// @return	An exception.
+///
+exception wait(uint nTicks)
+{
+	return wait_slack(nTicks, 0);
+}
+
+///
+/// @fn	exception wait_slack( uint nTicks, uint nSlack );
+///
+/// @brief	Waits for nTicks, the wake-up may be postponed by up to nSlack
+/// 		ticks to coincide with the wake-up of another task. The slack
+/// 		never postpones the wake-up to the deadline of the task.
+/// @param	nTicks	Waiting period.
+/// @param	nSlack	The ticks the wake-up may be postponed.
+///
+/// @return	An exception.
+///
+exception wait_slack(uint nTicks, uint nSlack)
+{
+	if (nTicks == 0)
+	{ // No reason to wait for nothing
+		return FAIL;
+	}
+
+	isr_off();		// Disable interrupts
+	uint nWake = osTicks + nTicks;
+	if (Running->DeadLine <= nWake + 1)
+	{ // No tick to spare before the deadline
+		nSlack = 0;
+	}
+	else if (nSlack > Running->DeadLine - nWake - 1)
+	{
+		nSlack = Running->DeadLine - nWake - 1;
+	}
+
+	OSList_readyRemove(readyList, runningListobj); // Remove current task from readyList
+	OSList_timerInsertSlack(timerList, runningListobj, nWake, nSlack);
+	reschedule();
+
+	if (Running->DeadLine <= ticks()) // Deadline reached
+	{
+		return DEADLINE_REACHED;
+	}
+
+	return SUCCESS;
+}
+
+///
+/// @fn	void set_ticks( uint no_of_ticks );
+///
+/// @brief	Sets the current system ticks.
+/// @param	no_of_ticks	The value to set the current system ticks to.
+///
+void set_ticks(uint nTicks)
+{
+	osTicks = nTicks;	//Set new value on osTicks
+}
+
+///
+/// @fn	uint ticks( void );
+///
+/// @brief	Gets the current system ticks.
+/// @return	Current system ticks.
+///
+uint ticks(void)
+{
+	return osTicks;
+}
+
+///
+/// @fn	void incTicks(void);
+///
+/// @brief	Increment ticks.
+///
+/// @author	Albin hjalmas.
+/// @date	1/26/2017
+///
+void incTicks(void)
+{
+	osTicks++;			//Increment osTicks
+}
+
+///
+/// @fn	uint deadline( void );
+///
+/// @brief	Gets the current tasks deadline.
+///
+/// @return	current tasks deadline.
+///
+uint deadline(void)
+{
+	if (Running != NULL)
+	{
+		return Running->DeadLine;
+	}
+	else
+	{
+		return 0;
+	}
+}
+
+///
+/// @fn	void set_deadline( uint nNew );
+///
+/// @brief	Sets the current tasks deadline.
+///
+/// @param	nNew	The new deadline.
+///
+void set_deadline(uint nNew)
+{
+	// Do nothing if there is no running task.
+	if (Running == NULL)
+	{
+		return;
+	}
+
+	isr_off();		// Disable interrupts
+
+	// The running task is not necessarily first in readyList
+	// when the system ceiling holds back earlier tasks.
+	Running->DeadLine = nNew;
+	OSList_readyDeadlineChanged(readyList, runningListobj);
+
+	reschedule();
+}
+
+///
+/// @fn	exception set_priority(uint nPriority)
+///
+/// The task is moved behind the other tasks of its new priority, it is
+/// preempted at once if it no longer has the highest priority.
+/// 
+/// @brief	Sets the priority of the current task, used by SCHED_FP.
+///
+/// @param	nPriority	The priority, 0 is the highest.
+///
+/// @return	FAIL if the priority is out of range else SUCCESS.
+///
+exception set_priority(uint nPriority)
+{
+	if (Running == NULL || Running->PC == idleTask || nPriority >= SCHED_PRIORITIES - 1)
+	{
+		return FAIL;
+	}
+
+	isr_off();
+	OSList_readyRemove(readyList, runningListobj);
+	runningListobj->nPriority = nPriority;
+	OSList_readyInsert(readyList, runningListobj);
+
+	reschedule();
+	return SUCCESS;
+}
+
+///
+/// @fn	exception set_time_slice(uint nTicks)
+///
+/// @brief	Sets the length of the time slices of tasks with equal deadlines.
+///
+/// @param	nTicks	The length in ticks, 0 disables time slicing.
+///
+/// @return	SUCCESS.
+///
+exception set_time_slice(uint nTicks)
+{
+	isr_off();
+	sliceLength = nTicks;
+	sliceTicks = 0;
+	isr_on();
+
+	return SUCCESS;
+}
+
+///
+/// @fn	exception set_preemption_threshold(uint nThreshold, uint nClass)
+///
+/// Tasks with a threshold of at least the difference of their deadlines
+/// and the same class never preempt each other. Lowering the threshold 
+/// lets a held back task preempt the caller at once.
+/// 
+/// @brief	Sets the preemption threshold of the current task.
+///
+/// @param	nThreshold	The threshold in ticks.
+/// @param	nClass	  	The preemption class.
+///
+/// @return	FAIL if there is no running task else SUCCESS.
+///
+exception set_preemption_threshold(uint nThreshold, uint nClass)
+{
+	if (Running == NULL || Running->PC == idleTask)
+	{
+		return FAIL;
+	}
+
+	isr_off();
+	runningListobj->nThreshold = nThreshold;
+	runningListobj->nPreemptClass = nClass;
+
+	reschedule();
+	return SUCCESS;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+///							Intertask communication
+//////////////////////////////////////////////////////////////////////////////
+
+///
+/// @fn	static void mailboxDeliver(mailbox* mBox, msg* pReceiver, void* pData)
+///
+/// Copies the data to a waiting receiver and wakes it. If the receiver
+/// is part of a receive_any() call its messages in the other mailboxes 
+/// are removed as well. Interrupts must be disabled.
+/// 
+/// @brief	Delivers data to a waiting receiver.
+///
+/// @param [in,out]	mBox	 	The mailbox.
+/// @param [in,out]	pReceiver	The receiving message.
+/// @param [in]		pData	 	The data.
+///
+static void mailboxDeliver(mailbox* mBox, msg* pReceiver, void* pData)
+{
+	memcpy(pReceiver->pData, pData, mBox->nDataSize); // Copy message
+	mBox->nBlockedMsg++;
+
+	// Leave the other mailboxes of a receive_any() call
+	for (msg* tmp = pReceiver->pSibling; tmp != NULL && tmp != pReceiver; tmp = tmp->pSibling)
+	{
+		msgRemove(tmp);
+		tmp->pMailbox->nBlockedMsg++;
+	}
+
+	// Tell the receiving task that the message was
+	// successfully sent and move it to the readyList
+	msgWake(pReceiver);
+}
+
+///
+/// @fn	static void callAccept(listobj* pServer, msg* pCall)
+///
+/// Hands a call to the task that received it. The caller is kept out of 
+/// all lists until the reply, the server inherits the deadline of the 
+/// caller if it is earlier. Interrupts must be disabled.
+/// 
+/// @brief	Accepts a call.
+///
+/// @param [in,out]	pServer	The task that received the call.
+/// @param [in,out]	pCall  	The message of the caller.
+///
+static void callAccept(listobj* pServer, msg* pCall)
+{
+	pServer->pCall = pCall;
+	pServer->nSavedDeadline = pServer->pTask->DeadLine;
+	pCall->pBlock->pMessage = NULL;
+
+	if (pCall->pBlock->pTask->DeadLine < pServer->pTask->DeadLine)
+	{ // Inherit the deadline and requeue the server if it is ready
+		pServer->pTask->DeadLine = pCall->pBlock->pTask->DeadLine;
+		if (OSList_readyRemove(readyList, pServer))
+		{
+			OSList_readyInsert(readyList, pServer);
+		}
+		msgDeadlineChanged(pServer);
+	}
+}
+
+///
+/// @fn	static void mailboxTake(mailbox* mBox, void* pData)
+///
+/// Receives the first message of a mailbox that holds sent messages, a
+/// blocked sender is moved to the readyList. Interrupts must be disabled.
+/// 
+/// @brief	Takes the first sent message.
+///
+/// @param [in,out]	mBox 	The mailbox.
+/// @param [out]	pData	The receive buffer.
+///
+static void mailboxTake(mailbox* mBox, void* pData)
+{
+	msg* tmp = mBox->pHead->pNext;
+
+	// Copy message
+	memcpy(pData, tmp->pData, mBox->nDataSize);
+
+	// Remove sending message from mailbox
+	msgRemove(tmp);
+
+	if (tmp->pReply != NULL)
+	{ // It is a call, the message lives on the stack of the caller
+		mBox->nBlockedMsg--;
+
+		// The caller waits for the reply outside of all lists
+		if (!OSList_remove(waitingList, tmp->pBlock))
+		{
+			OSList_readyRemove(readyList, tmp->pBlock);
+		}
+
+		callAccept(runningListobj, tmp);
+		return;
+	}
+
+	// If it was a send_wait message
+	if (mBox->nBlockedMsg > 0)
+	{
+		mBox->nBlockedMsg--;
+
+		// Move sending task to readyList
+		taskWake(tmp->pBlock);
+	}
+	else // It is a send_no_wait message.
+	{
+		mBox->nMessages--;
+	}
+
+	// Remove reference from task to message
+	// And then return allocated memory
+	tmp->pBlock->pMessage = NULL;
+	kernelFree(tmp);
+}
+
+///
+/// @fn	mailbox* create_mailbox(uint nMessages, uint nDataSize)
+///
+/// @brief	Creates a mailbox
+///
+/// @author	Albin Hjalmas
+/// @date	2/12/2017
+///
+/// @param	nMessages	The messages.
+/// @param	nDataSize	Size of the data.
+///
+/// @return	Null if it fails, else the new mailbox.
+///
+mailbox* create_mailbox(uint nMessages, uint nDataSize)
+{
+	// Check parameters
+	if (nMessages == 0 || nDataSize == 0)
+	{
+		return NULL;
+	}
+
+	// Allocate in one critical section so that the tick can not 
+	// restart the caller in between and leak the memory
+	isr_off();
+	mailbox* res = (mailbox*)kernelCalloc(1, sizeof(mailbox));
+	if (res == NULL)
+	{ // Memory allocation failed.
+		isr_on();
+		return NULL;
+	}
+
+	// Setup mailbox
+	res->nDataSize = nDataSize;
+	res->nMaxMessages = nMessages;
+
+	// Allocate the head and tail nodes
+	if (!msgQueueCreate(&res->pHead, &res->pTail))
+	{
+		kernelFree(res); // Dont forget to free previously allocated memory.
+		isr_on();
+		return NULL;
+	}
+	isr_on();
+	
+	return res;
+}
+
+///
+/// @fn	exception remove_mailbox(mailbox* mBox)
+///
+/// This call will remove the Mailbox if it is empty and return
+/// OK.Otherwise no action is taken and the call will return
+/// NOT_EMPTY.
+/// 
+/// @brief	Removes the mailbox described by mBox.
+///
+/// @author	Albin Hjalmas
+/// @date	2/15/2017
+///
+/// @param [in,out]	mBox	If non-null, the box.
+///
+/// @return	An exception.
+///
+exception remove_mailbox(mailbox* mBox)
+{
+	// Check arguments
+	if (mBox == NULL)
+	{
+		return FAIL;
+	}
+	else if (mBox->nMessages == 0 && mBox->nBlockedMsg == 0)
+	{ // Remove the mailbox
+		isr_off();
+		msgQueueFree(mBox->pHead);
+		kernelFree(mBox);
+		isr_on();
+		return OK;
+	}
+	else
+	{
+		return NOT_EMPTY;
+	}
+}
+
+///
+/// @fn	exception send_wait(mailbox* mBox, void* pData)
+///
+/// @brief	Sends a message to the specified mailbox.
+///
+/// @author	Albin Hjalmas
+/// @date	2/12/2017
+///
+/// @param [in,out]	mBox 	If non-null, the box.
+/// @param [in,out]	pData	If non-null, the data.
+///
+/// @return	An exception.
+///
+exception send_wait(mailbox* mBox, void* pData)
+{
+	// mailbox and data must be non-null 
+	// mailbox cannot contain asynchronous messages
+	// when trying to send synchronous messages
+	if (mBox == NULL || pData == NULL || mBox->nMessages != 0)
+	{
+		return FAIL;
+	}
+
+	isr_off();
+
+	if (mBox->nBlockedMsg < 0)
+	{ // The mailbox contains receiving messages
+		// Deliver to the first message added to the mailbox
+		mailboxDeliver(mBox, mBox->pHead->pNext, pData);
+	}
+	else // Put a new message in the mailbox.
+	{
+		// Allocate new message.
+		msg* tmp = (msg*)kernelCalloc(1, sizeof(msg));
+		if (tmp == NULL)
+		{
+			while (true) {}; // memory allocation failed
+		}
+
+		tmp->pBlock = runningListobj;
+		runningListobj->pMessage = tmp;
+		tmp->pData = (char*)pData;
+
+		// Add new message to mailbox in deadline order
+		msgDeadlineInsert(mBox->pHead, tmp);
+		mBox->nBlockedMsg++;
+
+		// Move current task from readyList to
+		// waitingList
+		OSList_readyRemove(readyList, runningListobj);
+		OSList_waitingInsert(waitingList, runningListobj);
+	}
+
+	// Execute possible context-switch
+	reschedule();
+
+	if (ticks() >= deadline()) // Deadline is reached
+	{
+		isr_off();
+
+		// Remove message from mailbox if it was not received
+		msg* tmp = runningListobj->pMessage;
+		if (tmp != NULL)
+		{
+			msgRemove(tmp);
+			runningListobj->pMessage = NULL;
+			kernelFree(tmp);
+			mBox->nBlockedMsg--;
+		}
+
+		// Enable interrupts again.
+		isr_on();
+		return DEADLINE_REACHED;
+	}
+	else
+	{
+		return SUCCESS;
+	}
+}
+
+///
+/// @fn	exception receive_wait(mailbox* mBox, void* pData)
+///
+/// @brief	Receive wait.
+///
+/// @author	Albin Hjalmas
+/// @date	2/15/2017
+///
+/// @param [in,out]	mBox 	If non-null, the box.
+/// @param [in,out]	pData	If non-null, the data.
+///
+/// @return	An exception.
+///
+exception receive_wait(mailbox* mBox, void* pData)
+{
+	// Check parameters, a call must be replied to before the next receive
+	if (mBox == NULL || pData == NULL || 
+		(runningListobj != NULL && runningListobj->pCall != NULL))
+	{
+		return FAIL;
+	}
+
+	isr_off();
+
+	// Check for messages ready to be received
+	if (mBox->nBlockedMsg > 0 || mBox->nMessages > 0)
+	{
+		mailboxTake(mBox, pData);
+	}
+	else // No sending messages waiting in mailbox
+	{
+		// Allocate new message.
+		msg* tmp = (msg*)kernelCalloc(1, sizeof(msg));
+		if (tmp == NULL)
+		{
+			while (true) {}; // memory allocation failed
+		}
+
+		tmp->pBlock = runningListobj;
+		runningListobj->pMessage = tmp;
+		tmp->pData = (char*)pData;
+
+		// Add new message to mailbox in deadline order
+		msgDeadlineInsert(mBox->pHead, tmp);
+		mBox->nBlockedMsg--;
+
+		// Move current task from readyList to
+		// waitingList
+		OSList_readyRemove(readyList, runningListobj);
+		OSList_waitingInsert(waitingList, runningListobj);
+	}
+
+	// Execute possible context-switch
+	reschedule();
+
+	if (ticks() >= deadline()) // Deadline is reached
+	{
+		isr_off();
+
+		// Remove message from mailbox if it was not received
+		msg* tmp = runningListobj->pMessage;
+		if (tmp != NULL)
+		{
+			msgRemove(tmp);
+			runningListobj->pMessage = NULL;
+			kernelFree(tmp);
+			mBox->nBlockedMsg++;
+		}
+
+		// Enable interrupts again.
+		isr_on();
+		return DEADLINE_REACHED;
+	}
+	else
+	{
+		return SUCCESS;
+	}
+
+}
+
+///
+/// @fn	static uint timeoutDelay(uint nTimeout)
+///
+/// @brief	Returns the number of ticks a blocking call with a timeout
+/// 		should spend in the timerList, the deadline of the calling
+/// 		task bounds the timeout.
+///
+/// @param	nTimeout	The timeout.
+///
+/// @return	The delay, at least one tick.
+///
+static uint timeoutDelay(uint nTimeout)
+{
+	uint left = (Running->DeadLine > osTicks) ? Running->DeadLine - osTicks : 1;
+	return (nTimeout < left) ? nTimeout : left;
+}
+
+///
+/// @fn	exception send_wait_timeout(mailbox* mBox, void* pData, uint nTimeout)
+///
+/// Sends a message like send_wait() but gives up after nTimeout ticks.
+/// The blocked task is kept in the timerList so its deadline is left
+/// untouched.
+/// 
+/// @brief	Sends a message with a timeout.
+///
+/// @param [in,out]	mBox	If non-null, the box.
+/// @param [in]		pData	If non-null, the data.
+/// @param 		   	nTimeout	The timeout in ticks.
+///
+/// @return	FAIL, DEADLINE_REACHED, TIMEOUT_REACHED or SUCCESS.
+///
+exception send_wait_timeout(mailbox* mBox, void* pData, uint nTimeout)
+{
+	if (mBox == NULL || pData == NULL || nTimeout == 0 || mBox->nMessages != 0 || Running == NULL)
+	{
+		return FAIL;
+	}
+
+	isr_off();
+
+	// The receiver frees the message when it is received
+	msg* tmp = (msg*)kernelCalloc(1, sizeof(msg));
+	if (tmp == NULL)
+	{ // Memory allocation failed.
+		isr_on();
+		return FAIL;
+	}
+
+	if (mBox->nBlockedMsg < 0)
+	{ // The mailbox contains receiving messages
+		kernelFree(tmp);
+		mailboxDeliver(mBox, mBox->pHead->pNext, pData);
+
+		reschedule();
+		return SUCCESS;
+	}
+
+	tmp->pBlock = runningListobj;
+	tmp->pData = (char*)pData;
+	runningListobj->pMessage = tmp;
+	msgDeadlineInsert(mBox->pHead, tmp);
+	mBox->nBlockedMsg++;
+
+	// Move current task from readyList to timerList
+	OSList_readyRemove(readyList, runningListobj);
+	OSList_timerInsert(timerList, runningListobj, timeoutDelay(nTimeout));
+
+	reschedule();
+
+	isr_off();
+
+	if (runningListobj->pMessage == NULL)
+	{ // The message was received
+		isr_on();
+		return SUCCESS;
+	}
+
+	// Timeout or deadline is reached, remove message from mailbox
+	msgRemove(tmp);
+	kernelFree(tmp);
+	mBox->nBlockedMsg--;
+	runningListobj->pMessage = NULL;
+	isr_on();
+
+	return (ticks() >= deadline()) ? DEADLINE_REACHED : TIMEOUT_REACHED;
+}
+
+///
+/// @fn	exception receive_wait_timeout(mailbox* mBox, void* pData, uint nTimeout)
+///
+/// Receives a message like receive_wait() but gives up after nTimeout 
+/// ticks. The blocked task is kept in the timerList so its deadline is 
+/// left untouched.
+/// 
+/// @brief	Receives a message with a timeout.
+///
+/// @param [in,out]	mBox	If non-null, the box.
+/// @param [out]	pData	If non-null, the receive buffer.
+/// @param 		   	nTimeout	The timeout in ticks.
+///
+/// @return	FAIL, DEADLINE_REACHED, TIMEOUT_REACHED or SUCCESS.
+///
+exception receive_wait_timeout(mailbox* mBox, void* pData, uint nTimeout)
+{
+	if (mBox == NULL || pData == NULL || nTimeout == 0 || Running == NULL
+		|| runningListobj->pCall != NULL)
+	{
+		return FAIL;
+	}
+
+	isr_off();
+
+	if (mBox->nBlockedMsg > 0 || mBox->nMessages > 0)
+	{ // A message is ready to be received
+		mailboxTake(mBox, pData);
+
+		reschedule();
+		return SUCCESS;
+	}
+
+	// The message lives on the stack of this task while it is blocked
+	msg waiter = { 0 };
+	waiter.pData = (char*)pData;
+	waiter.pBlock = runningListobj;
+	waiter.Status = TIMEOUT_REACHED;
+	runningListobj->pMessage = &waiter;
+	msgDeadlineInsert(mBox->pHead, &waiter);
+	mBox->nBlockedMsg--;
+
+	// Move current task from readyList to timerList
+	OSList_readyRemove(readyList, runningListobj);
+	OSList_timerInsert(timerList, runningListobj, timeoutDelay(nTimeout));
+
+	reschedule();
+
+	if (waiter.Status == SUCCESS)
+	{
+		return SUCCESS;
+	}
+
+	// Timeout or deadline is reached, leave the mailbox
+	isr_off();
+	msgRemove(&waiter);
+	mBox->nBlockedMsg++;
+	runningListobj->pMessage = NULL;
+	isr_on();
+
+	return (ticks() >= deadline()) ? DEADLINE_REACHED : TIMEOUT_REACHED;
+}
+
+///
+/// @fn	exception receive_any(mailbox** set, uint nMailboxes, void* pData, uint* pWhich)
+///
+/// Receives a message from the first mailbox in the set that holds one.
+/// If all mailboxes are empty the calling task is blocked on all of them
+/// at once until a message is sent to any of them or its deadline is 
+/// reached. The sender removes the messages of the task from the other 
+/// mailboxes when it delivers. pData must be large enough for the
+/// messages of every mailbox in the set.
+/// 
+/// @brief	Receives a message from any of a set of mailboxes.
+///
+/// @param [in,out]	set		  	The mailboxes.
+/// @param 		   	nMailboxes	The number of mailboxes in the set.
+/// @param [out]	pData	  	The receive buffer.
+/// @param [out]	pWhich	  	If non-null, receives the index of the mailbox.
+///
+/// @return	FAIL, DEADLINE_REACHED or SUCCESS.
+///
+exception receive_any(mailbox** set, uint nMailboxes, void* pData, uint* pWhich)
+{
+	exception res = DEADLINE_REACHED;
+	msg nodes[MAX_RECEIVE_ANY];	// One message per mailbox, set up only if blocking
+
+	// Check parameters
+	if (set == NULL || nMailboxes == 0 || nMailboxes > MAX_RECEIVE_ANY 
+		|| pData == NULL || Running == NULL || runningListobj->pCall != NULL)
+	{
+		return FAIL;
+	}
+
+	for (uint i = 0; i < nMailboxes; i++)
+	{
+		if (set[i] == NULL)
+		{
+			return FAIL;
+		}
+	}
+
+	isr_off();
+
+	for (uint i = 0; i < nMailboxes; i++)
+	{
+		if (set[i]->nBlockedMsg > 0 || set[i]->nMessages > 0)
+		{ // A message is ready to be received
+			mailboxTake(set[i], pData);
+			if (pWhich != NULL)
+			{
+				*pWhich = i;
+			}
+
+			reschedule();
+			return SUCCESS;
+		}
+	}
+
+	// Add a receiving message to every mailbox in deadline order
+	for (uint i = 0; i < nMailboxes; i++)
+	{
+		nodes[i].pData = (char*)pData;
+		nodes[i].Status = DEADLINE_REACHED;
+		nodes[i].pBlock = runningListobj;
+		nodes[i].pMailbox = set[i];
+		nodes[i].pSibling = &nodes[(i + 1) % nMailboxes];
+		nodes[i].pReply = NULL;
+		msgDeadlineInsert(set[i]->pHead, &nodes[i]);
+		set[i]->nBlockedMsg--;
+	}
+	runningListobj->pMessage = nodes;
+
+	// Move current task from readyList to
+	// waitingList
+	OSList_readyRemove(readyList, runningListobj);
+	OSList_waitingInsert(waitingList, runningListobj);
+
+	reschedule();
+
+	isr_off();
+
+	for (uint i = 0; i < nMailboxes; i++)
+	{
+		if (nodes[i].Status == SUCCESS)
+		{ // This message was delivered, the sender removed the others
+			res = SUCCESS;
+			if (pWhich != NULL)
+			{
+				*pWhich = i;
+			}
+		}
+		else if (nodes[i].pNext != NULL)
+		{ // Deadline is reached, leave the mailbox
+			msgRemove(&nodes[i]);
+			set[i]->nBlockedMsg++;
+		}
+	}
+	runningListobj->pMessage = NULL;
+
+	isr_on();
+	return res;
+}
+
+///
+/// @fn	exception call(mailbox* mBox, void* pRequest, void* pReply)
+///
+/// Sends a request and waits for the reply in one kernel entry. If a 
+/// task is waiting to receive on the mailbox the request is copied to it,
+/// it inherits the deadline of the caller and the cpu is handed over 
+/// directly. Otherwise the call is queued like a send_wait() message 
+/// and the caller may give up when its deadline is reached, once the 
+/// call has been received the caller waits until reply() is called.
+/// Requests and replies have the message size of the mailbox. A server
+/// must reply before it receives again.
+/// 
+/// @brief	Calls the task receiving on a mailbox.
+///
+/// @param [in,out]	mBox		If non-null, the box.
+/// @param [in]		pRequest	If non-null, the request.
+/// @param [out]	pReply  	If non-null, receives the reply.
+///
+/// @return	FAIL, NO_REPLY if the server terminated without a reply,
+/// 		DEADLINE_REACHED or SUCCESS.
+///
+exception call(mailbox* mBox, void* pRequest, void* pReply)
+{
+	if (mBox == NULL || pRequest == NULL || pReply == NULL || mBox->nMessages != 0 || Running == NULL)
+	{
+		return FAIL;
+	}
+
+	// The message lives on the stack of this task until the reply
+	msg request = { 0 };
+	request.pData = (char*)pRequest;
+	request.pReply = (char*)pReply;
+	request.pMailbox = mBox;
+	request.pBlock = runningListobj;
+	request.Status = DEADLINE_REACHED;
+
+	isr_off();
+
+	OSList_readyRemove(readyList, runningListobj);
+
+	if (mBox->nBlockedMsg < 0)
+	{ // A task is waiting to receive, hand the request to it
+		listobj* server = mBox->pHead->pNext->pBlock;
+		mailboxDeliver(mBox, mBox->pHead->pNext, pRequest);
+		callAccept(server, &request);
+	}
+	else // Queue the call until it is received
+	{
+		runningListobj->pMessage = &request;
+		msgDeadlineInsert(mBox->pHead, &request);
+		mBox->nBlockedMsg++;
+		OSList_waitingInsert(waitingList, runningListobj);
+	}
+
+	reschedule();
+
+	if (request.Status == SUCCESS)
+	{
+		return SUCCESS;
+	}
+
+	isr_off();
+
+	if (runningListobj->pMessage == &request)
+	{ // Deadline is reached before the call was received
+		msgRemove(&request);
+		mBox->nBlockedMsg--;
+		runningListobj->pMessage = NULL;
+	}
+
+	isr_on();
+	return request.Status;
+}
+
+///
+/// @fn	exception reply(void* pReply)
+///
+/// Copies the reply to the caller, gives back the inherited deadline and
+/// hands the cpu back to the caller if it has the earliest deadline.
+/// 
+/// @brief	Replies to a call.
+///
+/// @param [in]	pReply	If non-null, the reply.
+///
+/// @return	FAIL if no call is being handled, else SUCCESS.
+///
+exception reply(void* pReply)
+{
+	if (pReply == NULL || Running == NULL || runningListobj->pCall == NULL)
+	{
+		return FAIL;
+	}
+
+	isr_off();
+
+	msg* request = runningListobj->pCall;
+	memcpy(request->pReply, pReply, request->pMailbox->nDataSize);
+	request->Status = SUCCESS;
+	runningListobj->pCall = NULL;
+
+	if (Running->DeadLine != runningListobj->nSavedDeadline)
+	{ // Give back the inherited deadline
+		Running->DeadLine = runningListobj->nSavedDeadline;
+		OSList_readyRemove(readyList, runningListobj);
+		OSList_readyInsert(readyList, runningListobj);
+	}
+
+	OSList_readyInsert(readyList, request->pBlock);
+
+	reschedule();
+	return SUCCESS;
+}
+
+exception send_no_wait(mailbox* mBox, void* pData)
+{
+	// Check parameters
+	if (mBox == NULL || pData == NULL)
+	{
+		return FAIL;
+	}
+}
+
+int receive_no_wait(mailbox* mBox, void* pData)
+{
+	// Check parameters
+	if (pData = NULL)
+	{
+		return FAIL;
+	}
+}
+
+///
+/// @fn	int no_messages(mailbox* mBox)
+///
+/// @brief	Returns the number of messages currently contained within the 
+/// 		specified mailbox.
+///
+/// @author	Albin Hjalmas
+/// @date	2/13/2017
+///
+/// @param [in,out]	mBox	If non-null, the box.
+///
+/// @return	An int.
+///
+int no_messages(mailbox* mBox)
+{
+	if (mBox != NULL)
+	{
+		return abs(mBox->nMessages) + abs(mBox->nBlockedMsg);
+	}
+
+	return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+///							Mutexes (Stack Resource Policy)
+//////////////////////////////////////////////////////////////////////////////
+
+///
+/// @fn	mutex* create_mutex(uint nCeiling)
+///
+/// @brief	Creates a mutex.
+///
+/// @param	nCeiling	The shortest relative deadline of the tasks that lock the mutex.
+///
+/// @return	Null if it fails, else the new mutex.
+///
+mutex* create_mutex(uint nCeiling)
+{
+	// Check parameters
+	if (nCeiling == 0)
+	{
+		return NULL;
+	}
+
+	mutex* res = (mutex*)kernelCalloc(1, sizeof(mutex));
+	if (res == NULL)
+	{ // Memory allocation failed.
+		return NULL;
+	}
+
+	res->nCeiling = nCeiling;
+	return res;
+}
+
+///
+/// @fn	exception remove_mutex(mutex* pMutex)
+///
+/// @brief	Removes a mutex that is not locked.
+///
+/// @param [in,out]	pMutex	If non-null, the mutex.
+///
+/// @return	FAIL if the mutex is locked, else OK.
+///
+exception remove_mutex(mutex* pMutex)
+{
+	if (pMutex == NULL || pMutex->pOwner != NULL)
+	{
+		return FAIL;
+	}
+
+	kernelFree(pMutex);
+	return OK;
+}
+
+///
+/// @fn	exception lock_mutex(mutex* pMutex)
+///
+/// Under SRP a mutex is always free when a task that may lock it
+/// executes, the mutex is taken without blocking or a context switch.
+/// 
+/// @brief	Locks a mutex.
+///
+/// @param [in,out]	pMutex	If non-null, the mutex.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception lock_mutex(mutex* pMutex)
+{
+	if (pMutex == NULL || Running == NULL)
+	{
+		return FAIL;
+	}
+
+	isr_off();
+
+	if (pMutex->pOwner != NULL || runningListobj->nRelDeadline < pMutex->nCeiling)
+	{ // The ceiling of the mutex is too low for this task.
+		isr_on();
+		return FAIL;
+	}
+
+	// Take the mutex and raise the system ceiling
+	pMutex->pOwner = runningListobj;
+	pMutex->nPrevCeiling = systemCeiling;
+	if (pMutex->nCeiling < systemCeiling)
+	{
+		systemCeiling = pMutex->nCeiling;
+	}
+	runningListobj->nLocks++;
+	pMutex->pPrevLocked = runningListobj->pLocked;
+	runningListobj->pLocked = pMutex;
+
+	isr_on();
+	return SUCCESS;
+}
+
+///
+/// @fn	exception unlock_mutex(mutex* pMutex)
+///
+/// @brief	Unlocks a mutex.
+///
+/// @param [in,out]	pMutex	If non-null, the mutex.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception unlock_mutex(mutex* pMutex)
+{
+	if (pMutex == NULL || Running == NULL)
+	{
+		return FAIL;
+	}
+
+	isr_off();
+
+	if (pMutex->pOwner != runningListobj || runningListobj->pLocked != pMutex)
+	{ // Only the owner may unlock the mutex, in reverse order of locking
+		isr_on();
+		return FAIL;
+	}
+
+	// Release the mutex and restore the system ceiling
+	pMutex->pOwner = NULL;
+	systemCeiling = pMutex->nPrevCeiling;
+	runningListobj->nLocks--;
+	runningListobj->pLocked = pMutex->pPrevLocked;
+
+	reschedule();
+	return SUCCESS;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+///							Task notifications
+//////////////////////////////////////////////////////////////////////////////
+
+///
+/// @fn	listobj* current_task(void)
+///
+/// @brief	Returns the calling task.
+///
+/// @return	The calling task.
+///
+listobj* current_task(void)
+{
+	return runningListobj;
+}
+
+///
+/// @fn	static bool notifyPost(listobj* pTask, uint nValue, action eAction)
+///
+/// Updates the notification word and readies the task if it is waiting
+/// for any of the resulting bits. Interrupts must be disabled.
+/// 
+/// @brief	Posts a notification.
+///
+/// @param [in,out]	pTask  	The task.
+/// @param 		   	nValue 	The value.
+/// @param 		   	eAction	The action.
+///
+/// @return	True if the task was made ready.
+///
+static bool notifyPost(listobj* pTask, uint nValue, action eAction)
+{
+	switch (eAction)
+	{
+	case NOTIFY_SET_BITS:
+		pTask->pTask->Notification |= nValue;
+		break;
+	case NOTIFY_OVERWRITE:
+		pTask->pTask->Notification = nValue;
+		break;
+	default: // NOTIFY_INCREMENT
+		pTask->pTask->Notification++;
+		break;
+	}
+
+	if ((pTask->nNotifyMask & pTask->pTask->Notification) == 0)
+	{ // The task is not waiting for these bits
+		return false;
+	}
+
+	// The task is already ready if its deadline has been reached
+	pTask->nNotifyMask = 0;
+	taskWake(pTask);
+	return true;
+}
+
+///
+/// @fn	exception notify(listobj* pTask, uint nValue, action eAction)
+///
+/// @brief	Notifies a task.
+///
+/// @param [in,out]	pTask  	If non-null, the task.
+/// @param 		   	nValue 	The value.
+/// @param 		   	eAction	The action.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception notify(listobj* pTask, uint nValue, action eAction)
+{
+	if (pTask == NULL || eAction < NOTIFY_SET_BITS || eAction > NOTIFY_INCREMENT)
+	{
+		return FAIL;
+	}
+
+	isr_off();
+
+	if (!notifyPost(pTask, nValue, eAction))
+	{ // No context switch needed
+		isr_on();
+		return SUCCESS;
+	}
+
+	reschedule();
+	return SUCCESS;
+}
+
+///
+/// @fn	exception notify_isr(listobj* pTask, uint nValue, action eAction)
+///
+/// @brief	Notifies a task from an interrupt service routine.
+///
+/// @param [in,out]	pTask  	If non-null, the task.
+/// @param 		   	nValue 	The value.
+/// @param 		   	eAction	The action.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception notify_isr(listobj* pTask, uint nValue, action eAction)
+{
+	if (pTask == NULL || eAction < NOTIFY_SET_BITS || eAction > NOTIFY_INCREMENT)
+	{
+		return FAIL;
+	}
+
+	isr_off();
+	if (notifyPost(pTask, nValue, eAction))
+	{
+		isrSchedulingUpdate();
+	}
+	isr_on();
+
+	return SUCCESS;
+}
+
+///
+/// @fn	exception notify_wait(uint nMask, bool bClearOnExit, uint* pValue)
+///
+/// @brief	Waits for notification bits.
+///
+/// @param 		   	nMask			The bits to wait for.
+/// @param 		   	bClearOnExit	Clear the bits in nMask on success.
+/// @param [out]	pValue			If non-null, receives the notification word.
+///
+/// @return	FAIL, DEADLINE_REACHED or SUCCESS.
+///
+exception notify_wait(uint nMask, bool bClearOnExit, uint* pValue)
+{
+	if (nMask == 0 || Running == NULL)
+	{
+		return FAIL;
+	}
+
+	isr_off();
+
+	if ((Running->Notification & nMask) == 0)
+	{ // Block until notified
+		runningListobj->nNotifyMask = nMask;
+		OSList_readyRemove(readyList, runningListobj);
+		OSList_waitingInsert(waitingList, runningListobj);
+
+		reschedule();
+
+		isr_off();
+
+		if (runningListobj->nNotifyMask != 0)
+		{ // Deadline is reached
+			runningListobj->nNotifyMask = 0;
+			isr_on();
+			return DEADLINE_REACHED;
+		}
+	}
+
+	if (pValue != NULL)
+	{
+		*pValue = Running->Notification;
+	}
+
+	if (bClearOnExit)
+	{
+		Running->Notification &= ~nMask;
+	}
+
+	isr_on();
+	return SUCCESS;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+///							Semaphores
+//////////////////////////////////////////////////////////////////////////////
+
+///
+/// @fn	semaphore* create_semaphore(uint nCount)
+///
+/// @brief	Creates a counting semaphore.
+///
+/// @param	nCount	The initial count.
+///
+/// @return	Null if it fails, else the new semaphore.
+///
+semaphore* create_semaphore(uint nCount)
+{
+	isr_off();	// See create_mailbox()
+	semaphore* res = (semaphore*)kernelCalloc(1, sizeof(semaphore));
+	if (res == NULL)
+	{ // Memory allocation failed.
+		isr_on();
+		return NULL;
+	}
+
+	// Allocate the head and tail nodes
+	if (!msgQueueCreate(&res->pHead, &res->pTail))
+	{
+		kernelFree(res); // Dont forget to free previously allocated memory.
+		isr_on();
+		return NULL;
+	}
+
+	res->nCount = nCount;
+	isr_on();
+
+	return res;
+}
+
+///
+/// @fn	exception remove_semaphore(semaphore* pSem)
+///
+/// @brief	Removes a semaphore that no task is waiting on.
+///
+/// @param [in,out]	pSem	If non-null, the semaphore.
+///
+/// @return	FAIL, NOT_EMPTY if tasks are waiting or OK.
+///
+exception remove_semaphore(semaphore* pSem)
+{
+	if (pSem == NULL)
+	{
+		return FAIL;
+	}
+	else if (pSem->pHead->pNext != pSem->pTail)
+	{
+		return NOT_EMPTY;
+	}
+
+	isr_off();
+	msgQueueFree(pSem->pHead);
+	kernelFree(pSem);
+	isr_on();
+	return OK;
+}
+
+///
+/// @fn	static listobj* semaphoreGive(semaphore* pSem)
+///
+/// Hands the token to the waiter with the earliest deadline or increments
+/// the count if no task is waiting. Interrupts must be disabled.
+/// 
+/// @brief	Gives a semaphore.
+///
+/// @param [in,out]	pSem	The semaphore.
+///
+/// @return	The woken task or NULL.
+///
+static listobj* semaphoreGive(semaphore* pSem)
+{
+	if (pSem->pHead->pNext == pSem->pTail)
+	{ // Nobody is waiting
+		pSem->nCount++;
+		return NULL;
+	}
+
+	return msgWake(pSem->pHead->pNext);
+}
+
+///
+/// @fn	exception give_semaphore(semaphore* pSem)
+///
+/// @brief	Gives a semaphore, the calling task is preempted if
+/// 		the woken task has an earlier deadline.
+///
+/// @param [in,out]	pSem	If non-null, the semaphore.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception give_semaphore(semaphore* pSem)
+{
+	if (pSem == NULL)
+	{
+		return FAIL;
+	}
+
+	isr_off();
+
+	if (semaphoreGive(pSem) == NULL)
+	{ // No context switch needed
+		isr_on();
+		return SUCCESS;
+	}
+
+	reschedule();
+	return SUCCESS;
+}
+
+///
+/// @fn	exception give_semaphore_isr(semaphore* pSem)
+///
+/// @brief	Gives a semaphore from an interrupt service routine.
+///
+/// @param [in,out]	pSem	If non-null, the semaphore.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception give_semaphore_isr(semaphore* pSem)
+{
+	if (pSem == NULL)
+	{
+		return FAIL;
+	}
+
+	isr_off();
+	if (semaphoreGive(pSem) != NULL)
+	{
+		isrSchedulingUpdate();
+	}
+	isr_on();
+
+	return SUCCESS;
+}
+
+///
+/// @fn	exception take_wait(semaphore* pSem)
+///
+/// Takes a token, blocks until a token is given or the deadline
+/// of the calling task is reached. Waiting tasks are served in 
+/// deadline order.
+/// 
+/// @brief	Takes a semaphore.
+///
+/// @param [in,out]	pSem	If non-null, the semaphore.
+///
+/// @return	FAIL, DEADLINE_REACHED or SUCCESS.
+///
+exception take_wait(semaphore* pSem)
+{
+	if (pSem == NULL || Running == NULL)
+	{
+		return FAIL;
+	}
+
+	isr_off();
+
+	if (pSem->nCount > 0)
+	{ // A token is available
+		pSem->nCount--;
+		isr_on();
+		return SUCCESS;
+	}
+
+	// The message lives on the stack of this task while it is blocked
+	msg waiter = { 0 };
+	waiter.pBlock = runningListobj;
+	waiter.Status = DEADLINE_REACHED;
+	runningListobj->pMessage = &waiter;
+	msgDeadlineInsert(pSem->pHead, &waiter);
+
+	// Move current task from readyList to
+	// waitingList
+	OSList_readyRemove(readyList, runningListobj);
+	OSList_waitingInsert(waitingList, runningListobj);
+
+	reschedule();
+
+	if (waiter.Status != SUCCESS)
+	{ // Deadline is reached, leave the semaphore
+		isr_off();
+		msgRemove(&waiter);
+		runningListobj->pMessage = NULL;
+		isr_on();
+		return DEADLINE_REACHED;
+	}
+
+	return SUCCESS;
+}
+
+///
+/// @fn	exception take_no_wait(semaphore* pSem)
+///
+/// @brief	Takes a semaphore if a token is available, never blocks.
+///
+/// @param [in,out]	pSem	If non-null, the semaphore.
+///
+/// @return	FAIL if no token was available or SUCCESS.
+///
+exception take_no_wait(semaphore* pSem)
+{
+	exception res = FAIL;
+
+	if (pSem == NULL)
+	{
+		return FAIL;
+	}
+
+	isr_off();
+	if (pSem->nCount > 0)
+	{
+		pSem->nCount--;
+		res = SUCCESS;
+	}
+	isr_on();
+
+	return res;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+///							Event groups
+//////////////////////////////////////////////////////////////////////////////
+
+///
+/// @struct	eventWaiter
+///
+/// @brief	The condition of a task waiting on an event group, pointed to
+/// 		by the pData field of its msg.
+///
+typedef struct {
+	uint	nMask;			///<The bits waited for.
+	bool	bWaitAll;		///<True if all bits in nMask must be set.
+	bool	bClearOnExit;	///<Clear the bits in nMask when woken.
+	uint	nBits;			///<The bits of the group when the task was woken.
+} eventWaiter;
+
+///
+/// @def	eventSatisfied(nBits, pWaiter);
+///
+/// @brief	True if the bits satisfy the condition of the waiter.
+///
+/// @param	nBits  	The bits.
+/// @param	pWaiter	The eventWaiter.
+///
+#define eventSatisfied(nBits, pWaiter) ((pWaiter)->bWaitAll ? \
+	(((nBits) & (pWaiter)->nMask) == (pWaiter)->nMask) : \
+	(((nBits) & (pWaiter)->nMask) != 0))
+
 ///
-void terminate(void)
+/// @fn	eventgroup* create_event_group(void)
+///
+/// @brief	Creates an event group.
+///
+/// @return	Null if it fails, else the new event group.
+///
+eventgroup* create_event_group(void)
 {
-	// Disable interrupts
-	isr_off();
+	isr_off();	// See create_mailbox()
+	eventgroup* res = (eventgroup*)kernelCalloc(1, sizeof(eventgroup));
+	if (res == NULL)
+	{ // Memory allocation failed.
+		isr_on();
+		return NULL;
+	}
 
-	// Check os operating mode
-	if (opMode != RUNNING || Running == NULL) 
-	{ // The os is not running, so there is nothing to terminate
-		return;
+	// Allocate the head and tail nodes
+	if (!msgQueueCreate(&res->pHead, &res->pTail))
+	{
+		kernelFree(res); // Dont forget to free previously allocated memory.
+		isr_on();
+		return NULL;
 	}
+	isr_on();
 
-	OSList_remove(readyList, runningListobj); // Remove currently running task from readylist
-	//free(&(runningListobj->pTask)); // Deallocate the TCB
-	free(runningListobj); // Deallocate listobject
-	setRunningTask(OSList_peek(readyList)); // Set running task to be the next in readylist.
-	
-	// Switch to new task
-	LoadContext();
+	return res;
 }
 
 ///
-/// @fn	void run(void)
+/// @fn	exception remove_event_group(eventgroup* pGroup)
 ///
-/// @brief	Starts the kernel.
+/// @brief	Removes an event group that no task is waiting on.
 ///
-/// @author	Albin Hjalmas.
-/// @date	1/30/2017
+/// @param [in,out]	pGroup	If non-null, the event group.
 ///
-void run(void)
+/// @return	FAIL, NOT_EMPTY if tasks are waiting or OK.
+///
+exception remove_event_group(eventgroup* pGroup)
 {
-	// Disable interrupts
+	if (pGroup == NULL)
+	{
+		return FAIL;
+	}
+	else if (pGroup->pHead->pNext != pGroup->pTail)
+	{
+		return NOT_EMPTY;
+	}
+
 	isr_off();
-	
-	// Check that the kernel has been properly
-	// initialized before continuing with this function.
-	if (opMode != INIT || readyList == NULL || waitingList == NULL ||
-		timerList == NULL || readyList->size == 0)
+	msgQueueFree(pGroup->pHead);
+	kernelFree(pGroup);
+	isr_on();
+	return OK;
+}
+
+///
+/// @fn	static bool eventSet(eventgroup* pGroup, uint nBits)
+///
+/// Sets the bits and wakes every waiter whose condition is satisfied in
+/// one pass over the queue. Bits that woken waiters asked to clear are
+/// cleared after the pass so that all waiters see the same bits.
+/// Interrupts must be disabled.
+/// 
+/// @brief	Sets event bits.
+///
+/// @param [in,out]	pGroup	The event group.
+/// @param 		   	nBits 	The bits to set.
+///
+/// @return	True if any task was woken.
+///
+static bool eventSet(eventgroup* pGroup, uint nBits)
+{
+	uint clearMask = 0;
+	bool woken = false;
+	msg* tmp = pGroup->pHead->pNext;
+
+	pGroup->nBits |= nBits;
+
+	while (tmp != pGroup->pTail)
 	{
-		return;
+		msg* next = tmp->pNext;
+		eventWaiter* waiter = (eventWaiter*)tmp->pData;
+
+		if (eventSatisfied(pGroup->nBits, waiter))
+		{
+			waiter->nBits = pGroup->nBits;
+			if (waiter->bClearOnExit)
+			{
+				clearMask |= waiter->nMask;
+			}
+			msgWake(tmp);
+			woken = true;
+		}
+
+		tmp = next;
 	}
 
-	// Initialize timer interrupt
-#ifdef _X86_
-	_beginthread(timerInterrupt, 1000, NULL);
-#elif _CORTEX_M_
-	uint32_t prioritygroup = 0x00U;
-	prioritygroup = NVIC_GetPriorityGrouping();
-	NVIC_SetPriority(SysTick_IRQn, NVIC_EncodePriority(prioritygroup, 0, 0));
-	SysTick_Config(SystemCoreClock / 50); // 20ms 
-#endif
+	pGroup->nBits &= ~clearMask;
+	return woken;
+}
 
-	// Set the Running* pointer to the task
-	// with the earliest deadline.
-	setRunningTask(OSList_peek(readyList));
+///
+/// @fn	exception set_event_bits(eventgroup* pGroup, uint nBits)
+///
+/// @brief	Sets event bits, the calling task is preempted if a
+/// 		woken task has an earlier deadline.
+///
+/// @param [in,out]	pGroup	If non-null, the event group.
+/// @param 		   	nBits 	The bits.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception set_event_bits(eventgroup* pGroup, uint nBits)
+{
+	if (pGroup == NULL)
+	{
+		return FAIL;
+	}
 
-	// Set the kernel operating mode to RUNNING
-	opMode = RUNNING;
+	isr_off();
 
-	// Enable interrupts
+	if (!eventSet(pGroup, nBits))
+	{ // No context switch needed
+		isr_on();
+		return SUCCESS;
+	}
+
+	reschedule();
+	return SUCCESS;
+}
+
+///
+/// @fn	exception set_event_bits_isr(eventgroup* pGroup, uint nBits)
+///
+/// @brief	Sets event bits from an interrupt service routine.
+///
+/// @param [in,out]	pGroup	If non-null, the event group.
+/// @param 		   	nBits 	The bits.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception set_event_bits_isr(eventgroup* pGroup, uint nBits)
+{
+	if (pGroup == NULL)
+	{
+		return FAIL;
+	}
+
+	isr_off();
+	if (eventSet(pGroup, nBits))
+	{
+		isrSchedulingUpdate();
+	}
 	isr_on();
 
-	// Jump to current task.
-	LoadContext();
+	return SUCCESS;
 }
 
-//////////////////////////////////////////////////////////////////////////////
-///							Timing function definitions.
-//////////////////////////////////////////////////////////////////////////////
+///
+/// @fn	exception clear_event_bits(eventgroup* pGroup, uint nBits)
+///
+/// @brief	Clears event bits.
+///
+/// @param [in,out]	pGroup	If non-null, the event group.
+/// @param 		   	nBits 	The bits.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception clear_event_bits(eventgroup* pGroup, uint nBits)
+{
+	if (pGroup == NULL)
+	{
+		return FAIL;
+	}
+
+	isr_off();
+	pGroup->nBits &= ~nBits;
+	isr_on();
+
+	return SUCCESS;
+}
 
 ///
-/// @fn	exception wait( uint nTicks );
+/// @fn	exception wait_event_bits(eventgroup* pGroup, uint nMask, bool bWaitAll, bool bClearOnExit, uint* pBits)
 ///
-/// @brief	Causes the calling task to wait for a period of nTicks.
-/// @param	nTicks	Waiting period.
+/// @brief	Waits for event bits.
 ///
-/// @return	An exception.
+/// @param [in,out]	pGroup			If non-null, the event group.
+/// @param 		   	nMask			The bits to wait for.
+/// @param 		   	bWaitAll		Wait for all bits instead of any.
+/// @param 		   	bClearOnExit	Clear the bits in nMask on success.
+/// @param [out]	pBits			If non-null, receives the bits of the group.
 ///
-exception wait(uint nTicks)
+/// @return	FAIL, DEADLINE_REACHED or SUCCESS.
+///
+exception wait_event_bits(eventgroup* pGroup, uint nMask, bool bWaitAll, bool bClearOnExit, uint* pBits)
 {
-	if (nTicks == 0)
-	{ // No reason to wait for nothing
+	if (pGroup == NULL || nMask == 0 || Running == NULL)
+	{
 		return FAIL;
 	}
 
-	isr_off();		// Disable interrupts
-	volatile bool firstExecution = true;
-	SaveContext();
+	// The condition and message live on the stack of this task while it is blocked
+	eventWaiter cond = { nMask, bWaitAll, bClearOnExit, 0 };
 
-	if (firstExecution)
+	isr_off();
+
+	if (eventSatisfied(pGroup->nBits, &cond))
+	{ // Condition is already true
+		cond.nBits = pGroup->nBits;
+		if (bClearOnExit)
+		{
+			pGroup->nBits &= ~nMask;
+		}
+		isr_on();
+	}
+	else
 	{
-		firstExecution = !firstExecution;
-		OSList_remove(readyList, runningListobj); // Remove current task from readyList
-		OSList_timerInsert(timerList, runningListobj, nTicks); // Place current task in timerList
-		schedulingUpdate(); // initiate context-switch
-		LoadContext(); // Commit context-switch
+		msg waiter = { 0 };
+		waiter.pData = (char*)&cond;
+		waiter.pBlock = runningListobj;
+		waiter.Status = DEADLINE_REACHED;
+		runningListobj->pMessage = &waiter;
+		msgDeadlineInsert(pGroup->pHead, &waiter);
+
+		// Move current task from readyList to
+		// waitingList
+		OSList_readyRemove(readyList, runningListobj);
+		OSList_waitingInsert(waitingList, runningListobj);
+
+		reschedule();
+
+		if (waiter.Status != SUCCESS)
+		{ // Deadline is reached, leave the event group
+			isr_off();
+			msgRemove(&waiter);
+			runningListobj->pMessage = NULL;
+			isr_on();
+			return DEADLINE_REACHED;
+		}
 	}
-	else if (Running->DeadLine <= ticks()) // Deadline reached
+
+	if (pBits != NULL)
 	{
-		return DEADLINE_REACHED;
-	} 
+		*pBits = cond.nBits;
+	}
 
 	return SUCCESS;
 }
 
+//////////////////////////////////////////////////////////////////////////////
+///							Topics (publish/subscribe)
+//////////////////////////////////////////////////////////////////////////////
+
 ///
-/// @fn	void set_ticks( uint no_of_ticks );
+/// @struct	pubbuf
 ///
-/// @brief	Sets the current system ticks.
-/// @param	no_of_ticks	The value to set the current system ticks to.
+/// @brief	The header in front of every buffer of a topic.
 ///
-void set_ticks(uint nTicks)
-{
-	osTicks = nTicks;	//Set new value on osTicks
-}
+typedef struct pubbuf {
+	struct pubbuf*	pNext;	///<The next free buffer.
+	uint			nRefs;	///<The number of references, zero while free.
+} pubbuf;
 
 ///
-/// @fn	uint ticks( void );
+/// @def	bufHeader(pBuffer);
 ///
-/// @brief	Gets the current system ticks.
-/// @return	Current system ticks.
+/// @brief	Gets the header of a buffer.
 ///
-uint ticks(void)
+/// @param	pBuffer	The buffer.
+///
+#define bufHeader(pBuffer) (((pubbuf*)(pBuffer)) - 1)
+
+///
+/// @def	bufStride(nDataSize);
+///
+/// @brief	Gets the distance between two buffers of a pool, the headers
+/// 		are kept aligned.
+///
+/// @param	nDataSize	The size of the data.
+///
+#define bufStride(nDataSize) (sizeof(pubbuf) + \
+	(((nDataSize) + sizeof(pubbuf) - 1) / sizeof(pubbuf)) * sizeof(pubbuf))
+
+///
+/// @fn	static pubbuf* bufHeld(topic* pTopic, void* pBuffer)
+///
+/// @brief	Gets the header of a buffer that is held by someone.
+///
+/// @param [in]	pTopic 	The topic.
+/// @param [in]	pBuffer	The buffer.
+///
+/// @return	Null if the buffer is free or not from the pool of the topic,
+/// 		else the header.
+///
+static pubbuf* bufHeld(topic* pTopic, void* pBuffer)
 {
-	return osTicks;
+	uint stride = bufStride(pTopic->nDataSize);
+	char* pStart = (char*)bufHeader(pBuffer);
+
+	if (pStart < pTopic->pPool || 
+		pStart >= pTopic->pPool + pTopic->nBuffers * stride ||
+		(pStart - pTopic->pPool) % stride != 0)
+	{ // Not a buffer of this topic
+		return NULL;
+	}
+
+	pubbuf* res = (pubbuf*)pStart;
+	return (res->nRefs > 0) ? res : NULL;
 }
 
 ///
-/// @fn	void incTicks(void);
+/// @fn	static void bufRelease(topic* pTopic, pubbuf* pBuf)
 ///
-/// @brief	Increment ticks.
+/// @brief	Releases a reference, the last reference returns the buffer
+/// 		to the pool. The buffer must be held and interrupts must be
+/// 		disabled.
 ///
-/// @author	Albin hjalmas.
-/// @date	1/26/2017
+/// @param [in,out]	pTopic	The topic.
+/// @param [in,out]	pBuf  	The buffer header.
 ///
-void incTicks(void)
+static void bufRelease(topic* pTopic, pubbuf* pBuf)
 {
-	osTicks++;			//Increment osTicks
+	if (--pBuf->nRefs > 0)
+	{ // Others still hold the buffer
+		return;
+	}
+
+	pBuf->pNext = pTopic->pFree;
+	pTopic->pFree = pBuf;
+	pTopic->nClaimed--;
 }
 
 ///
-/// @fn	uint deadline( void );
+/// @fn	topic* create_topic(uint nBuffers, uint nDataSize)
 ///
-/// @brief	Gets the current tasks deadline.
+/// @brief	Creates a topic.
 ///
-/// @return	current tasks deadline.
+/// @param	nBuffers 	The number of buffers.
+/// @param	nDataSize	Size of the data.
 ///
-uint deadline(void)
+/// @return	Null if it fails, else the new topic.
+///
+topic* create_topic(uint nBuffers, uint nDataSize)
 {
-	if (Running != NULL)
+	// Check parameters
+	if (nBuffers == 0 || nDataSize == 0)
 	{
-		return Running->DeadLine;
+		return NULL;
 	}
-	else
+
+	isr_off();	// See create_mailbox()
+	topic* res = (topic*)kernelCalloc(1, sizeof(topic));
+	if (res == NULL)
+	{ // Memory allocation failed.
+		isr_on();
+		return NULL;
+	}
+
+	uint stride = bufStride(nDataSize);
+
+	res->pPool = (char*)kernelCalloc(nBuffers, stride);
+	if (res->pPool == NULL)
 	{
-		return 0;
+		kernelFree(res); // Dont forget to free previously allocated memory.
+		isr_on();
+		return NULL;
+	}
+
+	isr_on();
+
+	res->nDataSize = nDataSize;
+	res->nBuffers = nBuffers;
+
+	// Put all buffers in the pool
+	for (uint i = nBuffers; i > 0; i--)
+	{
+		pubbuf* buf = (pubbuf*)(res->pPool + (i - 1) * stride);
+		buf->pNext = res->pFree;
+		res->pFree = buf;
 	}
+
+	return res;
 }
 
 ///
-/// @fn	void set_deadline( uint nNew );
+/// @fn	exception remove_topic(topic* pTopic)
 ///
-/// @brief	Sets the current tasks deadline.
+/// @brief	Removes a topic that has no subscribers and whose buffers
+/// 		are all back in the pool.
 ///
-/// @param	nNew	The new deadline.
+/// @param [in,out]	pTopic	If non-null, the topic.
 ///
-void set_deadline(uint nNew)
+/// @return	FAIL, NOT_EMPTY if the topic has subscribers or a buffer is
+/// 		claimed, or OK.
+///
+exception remove_topic(topic* pTopic)
 {
-	// Do nothing if there is no running task.
-	if (Running == NULL)
+	if (pTopic == NULL)
 	{
-		return;
+		return FAIL;
 	}
-
-	isr_off();		// Disable interrupts
-	volatile bool firstExecution = true;
-	SaveContext();
-
-	if (firstExecution)
+	else if (pTopic->pSubscribers != NULL || pTopic->nClaimed > 0)
 	{
-		firstExecution = !firstExecution;
-		listobj* tmp = OSList_getFirst(readyList); // Get the currently running task from readyList
-		tmp->pTask->DeadLine = nNew;
-		OSList_readyInsert(readyList, tmp);
-		schedulingUpdate(); // initiate context-switch
-		LoadContext(); // Commit context-switch and reenable interrupts
+		return NOT_EMPTY;
 	}
-}
 
-//////////////////////////////////////////////////////////////////////////////
-///							Intertask communication
-//////////////////////////////////////////////////////////////////////////////
+	isr_off();
+	kernelFree(pTopic->pPool);
+	kernelFree(pTopic);
+	isr_on();
+	return OK;
+}
 
 ///
-/// @fn	mailbox* create_mailbox(uint nMessages, uint nDataSize)
-///
-/// @brief	Creates a mailbox
+/// @fn	subscriber* subscribe(topic* pTopic, uint nDepth)
 ///
-/// @author	Albin Hjalmas
-/// @date	2/12/2017
+/// @brief	Subscribes to a topic.
 ///
-/// @param	nMessages	The messages.
-/// @param	nDataSize	Size of the data.
+/// @param [in,out]	pTopic	If non-null, the topic.
+/// @param 		   	nDepth	The depth of the ring.
 ///
-/// @return	Null if it fails, else the new mailbox.
+/// @return	Null if it fails, else the new subscriber.
 ///
-mailbox* create_mailbox(uint nMessages, uint nDataSize)
+subscriber* subscribe(topic* pTopic, uint nDepth)
 {
 	// Check parameters
-	if (nMessages == 0 || nDataSize == 0)
+	if (pTopic == NULL || nDepth == 0)
 	{
 		return NULL;
 	}
 
-	mailbox* res = (mailbox*)calloc(1, sizeof(mailbox));
+	isr_off();	// See create_mailbox()
+	subscriber* res = (subscriber*)kernelCalloc(1, sizeof(subscriber));
 	if (res == NULL)
 	{ // Memory allocation failed.
+		isr_on();
 		return NULL;
 	}
 
-	// Setup mailbox
-	res->nDataSize = nDataSize;
-	res->nMaxMessages = nMessages;
-
-	// Allocate memory for head-node
-	res->pHead = (msg*)calloc(1, sizeof(msg));
-	if (res->pHead == NULL)
+	res->ppRing = (char**)kernelCalloc(nDepth, sizeof(char*));
+	if (res->ppRing == NULL)
 	{
-		free(res); // Dont forget to free previously allocated memory.
+		kernelFree(res); // Dont forget to free previously allocated memory.
+		isr_on();
 		return NULL;
 	}
 
-	// Allocate memory for tail-node.
-	res->pTail = (msg*)calloc(1, sizeof(msg));
-	if (res->pTail == NULL)
+	res->pSem = create_semaphore(0);
+	if (res->pSem == NULL)
 	{
-		free(res->pHead); // Dont forget to free previously allocated memory.
-		free(res);
+		kernelFree(res->ppRing); // Dont forget to free previously allocated memory.
+		kernelFree(res);
+		isr_on();
 		return NULL;
 	}
 
-	// Setup head and tail
-	res->pHead->pNext = res->pTail;
-	res->pTail->pPrevious = res->pHead;
-	
+	res->pTopic = pTopic;
+	res->nDepth = nDepth;
+	res->pNext = pTopic->pSubscribers;
+	pTopic->pSubscribers = res;
+	isr_on();
+
 	return res;
 }
 
 ///
-/// @fn	exception remove_mailbox(mailbox* mBox)
-///
-/// This call will remove the Mailbox if it is empty and return
-/// OK.Otherwise no action is taken and the call will return
-/// NOT_EMPTY.
-/// 
-/// @brief	Removes the mailbox described by mBox.
+/// @fn	exception unsubscribe(subscriber* pSub)
 ///
-/// @author	Albin Hjalmas
-/// @date	2/15/2017
+/// @brief	Ends a subscription.
 ///
-/// @param [in,out]	mBox	If non-null, the box.
+/// @param [in,out]	pSub	If non-null, the subscriber.
 ///
-/// @return	An exception.
+/// @return	FAIL, NOT_EMPTY if a task is waiting on the subscriber or OK.
 ///
-exception remove_mailbox(mailbox* mBox)
+exception unsubscribe(subscriber* pSub)
 {
-	// Check arguments
-	if (mBox == NULL)
+	if (pSub == NULL)
 	{
 		return FAIL;
 	}
-	else if (mBox->nMessages == 0 && mBox->nBlockedMsg == 0)
-	{ // Remove the mailbox
-		free(mBox->pHead);
-		free(mBox->pTail);
-		free(mBox);
+
+	isr_off();
+
+	if (pSub->pSem->pHead->pNext != pSub->pSem->pTail)
+	{ // A task is waiting for a publication
+		isr_on();
+		return NOT_EMPTY;
 	}
-	else
+
+	// Unlink from the topic
+	subscriber** pp = &pSub->pTopic->pSubscribers;
+	while (*pp != pSub)
 	{
-		return NOT_EMPTY;
+		pp = &(*pp)->pNext;
+	}
+	*pp = pSub->pNext;
+
+	// Release publications that were never received
+	for (; pSub->nCount > 0; pSub->nCount--)
+	{
+		bufRelease(pSub->pTopic, bufHeader(pSub->ppRing[pSub->nHead]));
+		pSub->nHead = (pSub->nHead + 1) % pSub->nDepth;
 	}
+
+	remove_semaphore(pSub->pSem);
+	kernelFree(pSub->ppRing);
+	kernelFree(pSub);
+	isr_on();
+	return OK;
 }
 
 ///
-/// @fn	exception send_wait(mailbox* mBox, void* pData)
-///
-/// @brief	Sends a message to the specified mailbox.
+/// @fn	void* claim_buffer(topic* pTopic)
 ///
-/// @author	Albin Hjalmas
-/// @date	2/12/2017
+/// @brief	Claims a buffer from the pool of a topic.
 ///
-/// @param [in,out]	mBox 	If non-null, the box.
-/// @param [in,out]	pData	If non-null, the data.
+/// @param [in,out]	pTopic	If non-null, the topic.
 ///
-/// @return	An exception.
+/// @return	Null if the pool is empty, else the buffer.
 ///
-exception send_wait(mailbox* mBox, void* pData)
+void* claim_buffer(topic* pTopic)
 {
-	// mailbox and data must be non-null 
-	// mailbox cannot contain asynchronous messages
-	// when trying to send synchronous messages
-	if (mBox == NULL || pData == NULL || mBox->nMessages != 0)
+	pubbuf* res = NULL;
+
+	if (pTopic == NULL)
 	{
-		return FAIL;
+		return NULL;
 	}
 
 	isr_off();
-	volatile bool firstExecution = true;
-	SaveContext();
-
-	if (firstExecution)
+	if (pTopic->pFree != NULL)
 	{
-		firstExecution = !firstExecution;
+		res = pTopic->pFree;
+		pTopic->pFree = res->pNext;
+		res->pNext = NULL;
+		res->nRefs = 1; // The reference of the claimer
+		pTopic->nClaimed++;
+	}
+	isr_on();
 
-		if (mBox->nBlockedMsg < 0)
-		{ // The mailbox contains receiving messages
-			msg* tmp = mBox->pHead->pNext; // Get the first message added to the mailbox
+	return (res != NULL) ? (void*)(res + 1) : NULL;
+}
 
-			memcpy(tmp->pData, pData, mBox->nDataSize); // Copy message
-			mBox->nBlockedMsg++;
+///
+/// @fn	exception publish(topic* pTopic, void* pBuffer)
+///
+/// Queues a reference to the buffer at every subscriber and gives its
+/// semaphore without rescheduling, the scheduler is consulted once
+/// after all subscribers have been served. A buffer that no subscriber
+/// took returns to the pool immediately.
+/// 
+/// @brief	Publishes a buffer.
+///
+/// @param [in,out]	pTopic 	If non-null, the topic.
+/// @param [in]		pBuffer	If non-null, a claimed buffer.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception publish(topic* pTopic, void* pBuffer)
+{
+	bool woken = false;
 
-			// Remove message from mailbox
-			tmp->pNext->pPrevious = tmp->pPrevious;
-			tmp->pPrevious->pNext = tmp->pNext;
-			tmp->pNext = NULL;
-			tmp->pPrevious = NULL;
-			// Set the message status i.e. tell
-			// receiving task that the message was 
-			// successfully sent.
-			tmp->Status = SUCCESS;
-			OSList_remove(waitingList, tmp->pBlock);	// Remove receiving task from waitingList
-			OSList_readyInsert(readyList, tmp->pBlock); // Add receiving task to readyList
-		}
-		else // Put a new message in the mailbox.
-		{
-			// Allocate new message.
-			msg* tmp = (msg*)calloc(1, sizeof(msg));
-			if (tmp == NULL)
-			{
-				while (true) {}; // memory allocation failed
-			}
+	if (pTopic == NULL || pBuffer == NULL)
+	{
+		return FAIL;
+	}
 
-			tmp->pBlock = runningListobj;
-			runningListobj->pMessage = tmp;
-			tmp->pData = (char*)pData;
+	isr_off();
 
-			// Add new message to mailbox
-			tmp->pPrevious = mBox->pTail->pPrevious;
-			tmp->pNext = mBox->pTail;
-			mBox->pTail->pPrevious->pNext = tmp;
-			mBox->pTail->pPrevious = tmp;
-			mBox->nBlockedMsg++;
+	pubbuf* buf = bufHeld(pTopic, pBuffer);
+	if (buf == NULL)
+	{ // Not claimed or not from this topic
+		isr_on();
+		return FAIL;
+	}
 
-			// Move current task from readyList to
-			// waitingList
-			OSList_remove(readyList, runningListobj);
-			OSList_waitingInsert(waitingList, runningListobj);
+	for (subscriber* sub = pTopic->pSubscribers; sub != NULL; sub = sub->pNext)
+	{
+		if (sub->nCount == sub->nDepth)
+		{ // The subscriber is lagging behind
+			sub->nDropped++;
+			continue;
 		}
 
-		// Execute possible context-switch
-		schedulingUpdate();
-		LoadContext();
-	}
-	else if (ticks() >= deadline()) // Deadline is reached
-	{
-		isr_off();
+		sub->ppRing[(sub->nHead + sub->nCount) % sub->nDepth] = (char*)pBuffer;
+		sub->nCount++;
+		buf->nRefs++;
 
-		//Remove message from mailbox
-		msg* tmp = mBox->pHead->pNext;
-		while (tmp->pNext != NULL)
+		if (semaphoreGive(sub->pSem) != NULL)
 		{
-			if (tmp == runningListobj->pMessage)
-			{ // If currently running task has a reference to tmp
-			  // Then remove it from the mailbox.
-				tmp->pPrevious->pNext = tmp->pNext;
-				tmp->pNext->pPrevious = tmp->pPrevious;
-				tmp->pNext = NULL;
-				tmp->pPrevious = NULL;
-				tmp->pBlock = NULL;
-				runningListobj->pMessage = NULL;
-				free(tmp);
-				mBox->nBlockedMsg--;
-				break;
-			}
-
-			// Update pointer.
-			tmp = tmp->pNext;
+			woken = true;
 		}
+	}
 
-		// Enable interrupts again.
+	// Drop the reference of the claimer, the buffer returns to the pool
+	// if nobody took it
+	bufRelease(pTopic, buf);
+
+	if (!woken)
+	{ // No context switch needed
 		isr_on();
-		return DEADLINE_REACHED;
-	}
-	else
-	{
 		return SUCCESS;
 	}
+
+	reschedule();
+	return SUCCESS;
 }
 
 ///
-/// @fn	exception receive_wait(mailbox* mBox, void* pData)
-///
-/// @brief	Receive wait.
+/// @fn	void* receive_publication(subscriber* pSub)
 ///
-/// @author	Albin Hjalmas
-/// @date	2/15/2017
+/// @brief	Receives the oldest publication of a subscriber.
 ///
-/// @param [in,out]	mBox 	If non-null, the box.
-/// @param [in,out]	pData	If non-null, the data.
+/// @param [in,out]	pSub	If non-null, the subscriber.
 ///
-/// @return	An exception.
+/// @return	Null if it fails or the deadline was reached, else the buffer.
 ///
-exception receive_wait(mailbox* mBox, void* pData)
+void* receive_publication(subscriber* pSub)
 {
-	// Check parameters
-	if (mBox == NULL || pData == NULL)
+	if (pSub == NULL || take_wait(pSub->pSem) != SUCCESS)
 	{
-		return FAIL;
+		return NULL;
 	}
 
 	isr_off();
-	volatile bool firstExecution = true;
-	SaveContext();
-
-	// Avoid endless loop due to SaveContext
-	if (firstExecution)
-	{
-		firstExecution = !firstExecution;
-
-		// Check for messages ready to be received
-		if (mBox->nBlockedMsg > 0 || mBox->nMessages > 0)
-		{
-			msg* tmp = mBox->pHead->pNext;
-
-			// Copy message
-			memcpy(pData, tmp->pData, mBox->nDataSize);
+	char* res = pSub->ppRing[pSub->nHead];
+	pSub->nHead = (pSub->nHead + 1) % pSub->nDepth;
+	pSub->nCount--;
+	isr_on();
 
-			// Remove sending message from mailbox
-			tmp->pNext->pPrevious = tmp->pPrevious;
-			tmp->pPrevious->pNext = tmp->pNext;
-			tmp->pPrevious = NULL;
-			tmp->pNext = NULL;
+	return res;
+}
 
-			// If it was a send_wait message
-			if (mBox->nBlockedMsg > 0)
-			{
-				mBox->nBlockedMsg--;
+///
+/// @fn	exception release_buffer(topic* pTopic, void* pBuffer)
+///
+/// @brief	Releases a reference to a buffer.
+///
+/// @param [in,out]	pTopic 	If non-null, the topic.
+/// @param [in]		pBuffer	If non-null, the buffer.
+///
+/// @return	FAIL if the buffer is not held or not from the pool of the
+/// 		topic, else SUCCESS.
+///
+exception release_buffer(topic* pTopic, void* pBuffer)
+{
+	if (pTopic == NULL || pBuffer == NULL)
+	{
+		return FAIL;
+	}
 
-				// Remove sending task from waitingList
-				// And add it to readyList
-				OSList_remove(waitingList, tmp->pBlock);
-				OSList_readyInsert(readyList, tmp->pBlock);
-			}
-			else // It is a send_no_wait message.
-			{
-				mBox->nMessages--;
-			}
+	isr_off();
 
-			// Remove reference from task to message
-			// And then return allocated memory
-			tmp->pBlock->pMessage = NULL;
-			free(tmp);
-		}
-		else // No sending messages waiting in mailbox
-		{
-			// Allocate new message.
-			msg* tmp = (msg*)calloc(1, sizeof(msg));
-			if (tmp == NULL)
-			{
-				while (true) {}; // memory allocation failed
-			}
+	pubbuf* buf = bufHeld(pTopic, pBuffer);
+	if (buf == NULL)
+	{ // Already released or not from this topic
+		isr_on();
+		return FAIL;
+	}
 
-			tmp->pBlock = runningListobj;
-			runningListobj->pMessage = tmp;
-			tmp->pData = (char*)pData;
+	bufRelease(pTopic, buf);
+	isr_on();
 
-			// Add new message to mailbox
-			tmp->pPrevious = mBox->pTail->pPrevious;
-			tmp->pNext = mBox->pTail;
-			mBox->pTail->pPrevious->pNext = tmp;
-			mBox->pTail->pPrevious = tmp;
-			mBox->nBlockedMsg--;
+	return SUCCESS;
+}
 
-			// Move current task from readyList to
-			// waitingList
-			OSList_remove(readyList, runningListobj);
-			OSList_waitingInsert(waitingList, runningListobj);
-		}
+//////////////////////////////////////////////////////////////////////////////
+///							Latest-value channels
+//////////////////////////////////////////////////////////////////////////////
 
-		// Execute possible context-switch
-		schedulingUpdate();
-		LoadContext();
-	}
-	else if (ticks() >= deadline()) // Deadline is reached
+///
+/// @fn	channel* create_channel(uint nDataSize)
+///
+/// @brief	Creates a latest-value channel.
+///
+/// @param	nDataSize	Size of the data.
+///
+/// @return	Null if it fails, else the new channel.
+///
+channel* create_channel(uint nDataSize)
+{
+	// Check parameters
+	if (nDataSize == 0)
 	{
-		isr_off();
-
-		//Remove message from mailbox
-		msg* tmp = mBox->pHead->pNext;
-		while (tmp->pNext != NULL)
-		{
-			if (tmp == runningListobj->pMessage)
-			{ // If currently running task has a reference to tmp
-			  // Then remove it from the mailbox.
-				tmp->pPrevious->pNext = tmp->pNext;
-				tmp->pNext->pPrevious = tmp->pPrevious;
-				tmp->pNext = NULL;
-				tmp->pPrevious = NULL;
-				tmp->pBlock = NULL;
-				runningListobj->pMessage = NULL;
-				free(tmp);
-				mBox->nBlockedMsg++;
-				break;
-			}
-
-			// Update pointer.
-			tmp = tmp->pNext;
-		}
+		return NULL;
+	}
 
-		// Enable interrupts again.
+	isr_off();	// See create_mailbox()
+	channel* res = (channel*)kernelCalloc(1, sizeof(channel));
+	if (res == NULL)
+	{ // Memory allocation failed.
 		isr_on();
-		return DEADLINE_REACHED;
+		return NULL;
 	}
-	else
+
+	res->pData = (char*)kernelCalloc(2, nDataSize);
+	if (res->pData == NULL)
 	{
-		return SUCCESS;
+		kernelFree(res); // Dont forget to free previously allocated memory.
+		isr_on();
+		return NULL;
 	}
 
+	isr_on();
+
+	res->nDataSize = nDataSize;
+	return res;
 }
 
-exception send_no_wait(mailbox* mBox, void* pData)
+///
+/// @fn	exception remove_channel(channel* pChannel)
+///
+/// @brief	Removes a channel.
+///
+/// @param [in,out]	pChannel	If non-null, the channel.
+///
+/// @return	FAIL or OK.
+///
+exception remove_channel(channel* pChannel)
 {
-	// Check parameters
-	if (mBox == NULL || pData == NULL)
+	if (pChannel == NULL)
 	{
 		return FAIL;
 	}
+
+	isr_off();
+	kernelFree(pChannel->pData);
+	kernelFree(pChannel);
+	isr_on();
+	return OK;
 }
 
-int receive_no_wait(mailbox* mBox, void* pData)
+///
+/// @fn	exception write_channel(channel* pChannel, void* pData)
+///
+/// Both copies are written in turn, each after the sequence has moved
+/// the readers to the other copy. A reader that interrupts the writer
+/// reads the copy that is not being written.
+/// 
+/// @brief	Writes the latest value.
+///
+/// @param [in,out]	pChannel	If non-null, the channel.
+/// @param [in]		pData   	If non-null, the value.
+///
+/// @return	FAIL or SUCCESS.
+///
+exception write_channel(channel* pChannel, void* pData)
 {
-	// Check parameters
-	if (pData = NULL)
+	if (pChannel == NULL || pData == NULL)
 	{
 		return FAIL;
 	}
+
+	pChannel->nSeq++;	// Odd, readers use the second copy
+	memoryBarrier();
+	memcpy(pChannel->pData, pData, pChannel->nDataSize);
+	memoryBarrier();
+	pChannel->nSeq++;	// Even, readers use the first copy
+	memoryBarrier();
+	memcpy(pChannel->pData + pChannel->nDataSize, pData, pChannel->nDataSize);
+	memoryBarrier();
+	pChannel->bWritten = true;
+
+	return SUCCESS;
 }
 
 ///
-/// @fn	int no_messages(mailbox* mBox)
-///
-/// @brief	Returns the number of messages currently contained within the 
-/// 		specified mailbox.
+/// @fn	exception read_channel(channel* pChannel, void* pData)
 ///
-/// @author	Albin Hjalmas
-/// @date	2/13/2017
+/// @brief	Reads the latest value.
 ///
-/// @param [in,out]	mBox	If non-null, the box.
+/// @param [in,out]	pChannel	If non-null, the channel.
+/// @param [out]	pData   	If non-null, receives the value.
 ///
-/// @return	An int.
+/// @return	FAIL if nothing has been written yet, else SUCCESS.
 ///
-int no_messages(mailbox* mBox)
+exception read_channel(channel* pChannel, void* pData)
 {
-	if (mBox != NULL)
+	uint seq;
+
+	if (pChannel == NULL || pData == NULL)
 	{
-		return abs(mBox->nMessages) + abs(mBox->nBlockedMsg);
+		return FAIL;
 	}
 
-	return 0;
+	if (!pChannel->bWritten)
+	{ // Nothing has been written yet
+		return FAIL;
+	}
+
+	do
+	{
+		seq = pChannel->nSeq;
+		memoryBarrier();
+		memcpy(pData, pChannel->pData + (seq & 1) * pChannel->nDataSize, pChannel->nDataSize);
+		memoryBarrier();
+	} while (seq != pChannel->nSeq);
+
+	return SUCCESS;
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -928,30 +4574,44 @@ int no_messages(mailbox* mBox)
 ///
 /// @fn	extern void isr_off(void);
 ///
+/// Enters a kernel critical section, critical sections nest.
+/// On Cortex-M BASEPRI is raised to KERNEL_INTERRUPT_PRIORITY instead
+/// of setting PRIMASK so that interrupts above the kernel priority 
+/// ceiling are never delayed by the kernel.
+/// 
 /// @brief	Disables interrupts.
 ///
 extern void isr_off(void)
 {
 	isrOnState = false;
-	
+
 #ifdef _CORTEX_M_
-	__disable_irq();
+	__set_BASEPRI(KERNEL_INTERRUPT_PRIORITY << (8 - __NVIC_PRIO_BITS));
+	__DSB();
+	__ISB();
 #endif
+
+	isrNesting++;
 }
 
 ///
 /// @fn	extern void isr_on(void);
 ///
+/// Leaves a kernel critical section, interrupts are enabled
+/// when the outermost critical section is left.
+/// 
 /// @brief	Enables interrupts.
 ///
 extern void isr_on(void)
 {
-	isrOnState = true;
-	
+	if (isrNesting > 0 && --isrNesting > 0)
+	{ // Still inside an enclosing critical section
+		return;
+	}
+
 #ifdef _CORTEX_M_
-	__enable_irq();
+	__set_BASEPRI(0);
 #endif
-}
-
-
 
+	isrOnState = true;
+}